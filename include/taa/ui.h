@@ -43,6 +43,7 @@ enum taa_ui_type_e
     taa_UI_CONTAINER_END,
     taa_UI_LABEL,
     taa_UI_NUMBERBOX,
+    taa_UI_PARAGRAPH,
     taa_UI_TEXTBOX,
     taa_UI_VSCROLLBAR,
 };
@@ -86,6 +87,14 @@ enum
     taa_UI_HEIGHT_FILL    = -3,
 };
 
+enum
+{
+    /**
+     * @brief size in bytes of the user data stored with each control state
+     */
+    taa_UI_STATE_BLOB_SIZE = 16
+};
+
 enum
 {
     taa_UI_FLAG_NONE      = 0,
@@ -94,6 +103,52 @@ enum
     taa_UI_FLAG_FOCUS     = 1 << 2, // 4
     taa_UI_FLAG_HOVER     = 1 << 3, // 8
     taa_UI_FLAG_PRESSED   = 1 << 4, // 16
+    taa_UI_FLAG_CULLED    = 1 << 5, // 32
+};
+
+enum
+{
+    /**
+     * @brief calculate damage rectangles in taa_ui_end by comparing the
+     *        control list against the previous frame
+     */
+    taa_UI_OPTION_DAMAGE = 1 << 0,
+    /**
+     * @brief store only a pointer to the text of labels and buttons. The
+     *        caller guarantees the text remains valid and unmodified until
+     *        the next call to taa_ui_begin.
+     */
+    taa_UI_OPTION_STATIC_TEXT = 1 << 1,
+    /**
+     * @brief store the text of labels and buttons in a table that persists
+     *        across frames, so each distinct string is only copied once
+     */
+    taa_UI_OPTION_INTERN_TEXT = 1 << 2,
+    /**
+     * @brief hash the control stream submitted during each frame. If the
+     *        stream, view size and input match the previous frame, layout
+     *        and input processing are skipped, and taa_ui_end returns the
+     *        previous control list flagged as unchanged.
+     */
+    taa_UI_OPTION_IDLE = 1 << 3,
+    /**
+     * @brief skip the layout of subtrees that are clipped away entirely,
+     *        such as rows scrolled out of view. The controls of a culled
+     *        subtree are flagged with taa_UI_FLAG_CULLED and given empty
+     *        clip rects. Only the rect of the control at the root of the
+     *        subtree is calculated, so the extent of the visible container
+     *        and the range of its scrollbar are unaffected.
+     */
+    taa_UI_OPTION_CULL = 1 << 4,
+};
+
+enum
+{
+    /**
+     * @brief maximum number of damage rectangles reported per frame. when
+     *        more areas change, the rectangles are merged
+     */
+    taa_UI_MAX_DAMAGE_RECTS = 8
 };
 
 //****************************************************************************
@@ -106,6 +161,15 @@ typedef enum taa_ui_valign_e taa_ui_valign;
 
 typedef unsigned int taa_ui_styleid;
 
+/**
+ * @details ids are hashed from the path of parent containers and a key
+ * unique among siblings, such as a button label, an explicit container id,
+ * or the order of the control among siblings of the same type. Unlike
+ * handles, ids remain stable across frames as long as the path to the
+ * control does not change. Zero is never a valid id.
+ */
+typedef uint32_t taa_ui_id;
+
 /**
  * @details handles are returned from control functions so that the control
  * may be referenced later in the frame. For example, scroll controls require
@@ -124,9 +188,54 @@ typedef struct taa_ui_rect_s taa_ui_rect;
 typedef struct taa_ui_style_s taa_ui_style;
 typedef struct taa_ui_iddata_s taa_ui_iddata;
 typedef struct taa_ui_scrolldata_s taa_ui_scrolldata;
+typedef struct taa_ui_textline_s taa_ui_textline;
 typedef struct taa_ui_textdata_s taa_ui_textdata;
 typedef struct taa_ui_control_s taa_ui_control;
 typedef struct taa_ui_controllist_s  taa_ui_controllist;
+typedef struct taa_ui_list_s taa_ui_list;
+typedef struct taa_ui_state_s taa_ui_state;
+typedef struct taa_ui_regionusage_s taa_ui_regionusage;
+typedef struct taa_ui_usage_s taa_ui_usage;
+
+/**
+ * @brief callback used by virtualized lists with variable row heights
+ * @param userdata the userdata pointer from the list
+ * @param item index of the row being measured
+ * @return the height of the row in pixels
+ */
+typedef int (*taa_ui_list_heightfunc)(void* userdata, int item);
+
+/**
+ * @brief a batch of work items passed to a taa_ui_dispatchfunc
+ * @param args the args pointer passed to the dispatch callback
+ * @param index index of the work item to run
+ */
+typedef void (*taa_ui_taskfunc)(void* args, int index);
+
+/**
+ * @brief callback used to lay out independent subtrees in parallel
+ * @details the callback must call task(args, i) once for every i in
+ * [0, count). The calls may be made in any order and from any threads,
+ * but the callback must not return until all of them have returned.
+ * @param userdata the userdata pointer given to taa_ui_set_layout_dispatch
+ */
+typedef void (*taa_ui_dispatchfunc)(
+    void* userdata,
+    taa_ui_taskfunc task,
+    void* args,
+    int count);
+
+/**
+ * @brief callback that draws a control as soon as layout has placed it
+ * @param userdata the userdata pointer given to taa_ui_set_draw_callback
+ * @param ctrls the control list of the frame. The caret, selection and
+ *        view size are valid, but the controls are still being placed
+ * @param control the control, whose rects and data are final
+ */
+typedef void (*taa_ui_drawfunc)(
+    void* userdata,
+    const taa_ui_controllist* ctrls,
+    const taa_ui_control* control);
 
 typedef struct taa_ui_s taa_ui;
 
@@ -188,6 +297,9 @@ struct taa_ui_iddata_s
 {
     taa_ui_datatype type;
     uint32_t id;
+    /// number of controls between a container begin control and its end
+    /// control, so that its subtree can be skipped. zero for end controls
+    uint32_t numdescendants;
 };
 
 struct taa_ui_scrolldata_s
@@ -200,12 +312,30 @@ struct taa_ui_scrolldata_s
     taa_ui_rect sliderpane;
 };
 
+/**
+ * @details a line of a paragraph, as broken by layout to fit its width
+ */
+struct taa_ui_textline_s
+{
+    /// offset of the first character of the line within the text
+    uint32_t begin;
+    /// number of characters in the line, excluding trailing spaces
+    uint32_t length;
+    int32_t width;
+};
+
 struct taa_ui_textdata_s
 {
     taa_ui_datatype type;
     const char* text;
     uint32_t textlength;
     uint32_t textcapacity;
+    /// width of the text measured by layout, negative if not measured
+    int32_t textwidth;
+    /// number of lines of a paragraph, zero for other controls
+    uint32_t numlines;
+    /// lines of a paragraph, valid until the next call to taa_ui_end
+    const taa_ui_textline* lines;
 };
 
 struct taa_ui_control_s
@@ -213,6 +343,10 @@ struct taa_ui_control_s
     taa_ui_type type;
     taa_ui_styleid styleid;
     uint32_t flags;
+    /**
+     * @details stable id of the control
+     */
+    taa_ui_id id;
     /**
      * @details unclipped control rectangle in screen space
      */
@@ -239,6 +373,100 @@ struct taa_ui_controllist_s
     int32_t caret;
     uint32_t selectstart;
     uint32_t selectlength;
+    /**
+     * @details screen space areas that differ from the previous frame. If
+     * taa_UI_OPTION_DAMAGE is not enabled, this is a single rectangle that
+     * covers the view. Zero rectangles means nothing changed.
+     */
+    const taa_ui_rect* damagerects;
+    uint32_t numdamagerects;
+    /**
+     * @details nonzero if taa_UI_OPTION_IDLE is enabled and the control list
+     * is identical to the previous frame, so the previous draw list may be
+     * reused instead of being generated again.
+     */
+    uint32_t isunchanged;
+};
+
+/**
+ * @details persistent state for a virtualized list. The struct is owned by
+ * the caller and must remain valid across frames. numitems, itemheight,
+ * heightfunc, userdata and spacing are inputs set by the caller; the
+ * remaining fields are maintained by the ui simulation and should be
+ * zero initialized, except for contenth which should start at -1.
+ */
+struct taa_ui_list_s
+{
+    /// number of rows in the list
+    int32_t numitems;
+    /// fixed height of every row, used when heightfunc is NULL
+    int32_t itemheight;
+    /// optional callback that measures rows of varying height
+    taa_ui_list_heightfunc heightfunc;
+    /// user data passed to heightfunc
+    void* userdata;
+    /// vertical space between rows
+    int32_t spacing;
+    /// total height of all rows. set to -1 to force it to be recalculated
+    /// when the heights returned by heightfunc change
+    int32_t contenth;
+    /// height of the list viewport as measured by the previous frame
+    int32_t viewh;
+    /// first visible row from the previous frame
+    int32_t anchoritem;
+    /// vertical offset of anchoritem from the top of the list
+    int32_t anchory;
+    /// number of items contenth was calculated for
+    int32_t measureditems;
+};
+
+/**
+ * @details state that persists across frames for a control id. States are
+ * evicted when they have not been accessed for a number of frames.
+ */
+struct taa_ui_state_s
+{
+    /// id of the control the state belongs to
+    taa_ui_id id;
+    /// frame counter of the last time the state was accessed
+    uint32_t frame;
+    /// taa_UI_FLAG_FOCUS if the control holds focus
+    uint32_t flags;
+    /// last scroll position of a container
+    int32_t scrollx;
+    int32_t scrolly;
+    /// last caret and selection of a text control
+    int32_t caret;
+    int32_t selectstart;
+    int32_t selectlength;
+    /// arbitrary user data
+    unsigned char blob[taa_UI_STATE_BLOB_SIZE];
+    /// subtree recorded by taa_ui_memo_end, maintained internally
+    uint32_t memoframe;
+    int32_t memoindex;
+};
+
+/**
+ * @details memory usage of one of the buffers of a ui context, in bytes
+ */
+struct taa_ui_regionusage_s
+{
+    /// amount used by the most recent frame
+    size_t frameused;
+    /// most used by any frame since the context was created
+    size_t peakused;
+    /// amount of memory currently committed
+    size_t committed;
+    /// amount of address space reserved, which is the limit of the buffer
+    size_t reserved;
+};
+
+struct taa_ui_usage_s
+{
+    taa_ui_regionusage controls;
+    taa_ui_regionusage layout;
+    taa_ui_regionusage text;
+    taa_ui_regionusage stack;
 };
 
 //****************************************************************************
@@ -305,6 +533,28 @@ taa_UI_LINKAGE void taa_ui_begin(
     const taa_window_event* winevents,
     int numevents);
 
+/**
+ * @brief begins recording a subtree on a child context
+ * @details A child context is created with taa_ui_create, using the same
+ * stylesheet as the parent, and records controls into its own buffers so
+ * independent subtrees can be built on separate threads. This function
+ * must be called on the thread that owns the parent, after taa_ui_begin.
+ * The child may then be filled on any thread, and is added to the parent
+ * with taa_ui_splice instead of calling taa_ui_end. The child keeps its
+ * own persistent states, so the same child should be used for the same
+ * subtree each frame.
+ * @param child the child context
+ * @param parent the context the subtree will be spliced into
+ * @param rootid id the ids of the subtree are derived from. Passing the
+ *        result of taa_ui_hash_id on the parent at the splice location
+ *        gives the same ids as building the subtree between taa_ui_push_id
+ *        and taa_ui_pop_id with the same key.
+ */
+taa_UI_LINKAGE void taa_ui_begin_child(
+    taa_ui* child,
+    const taa_ui* parent,
+    taa_ui_id rootid);
+
 taa_UI_LINKAGE taa_ui_handle taa_ui_button(
     taa_ui* ui,
     taa_ui_styleid styleid,
@@ -313,6 +563,62 @@ taa_UI_LINKAGE taa_ui_handle taa_ui_button(
     const char* txt,
     unsigned int* flags_out);
 
+/**
+ * @brief finds the cell of a grid that contains a point
+ * @details the cells are numbered in the order the children of the grid
+ * were added, so the result is the ordinal of the child in that cell. The
+ * caller must check the result against the number of children.
+ * @param numcols number of columns in the grid
+ * @param cellw width of a cell
+ * @param cellh height of a cell
+ * @param spacing space between cells
+ * @param originx horizontal position of the top left cell
+ * @param originy vertical position of the top left cell
+ * @param x horizontal position of the point
+ * @param y vertical position of the point
+ * @return ordinal of the cell, or -1 if the point is not within a cell
+ */
+taa_UI_LINKAGE int taa_ui_calc_grid_cell(
+    int numcols,
+    int cellw,
+    int cellh,
+    int spacing,
+    int originx,
+    int originy,
+    int x,
+    int y);
+
+/**
+ * @brief finds the range of grid cells in the rows overlapping a span
+ * @details this may be used to only add the children of a grid that are
+ * within its viewport. The end of the range must be clamped by the caller
+ * to the number of children.
+ * @param numcols number of columns in the grid
+ * @param cellh height of a cell
+ * @param spacing space between cells
+ * @param originy vertical position of the top row
+ * @param y top of the span
+ * @param h height of the span
+ * @param begin_out ordinal of the first cell in the range
+ * @param end_out ordinal one past the last cell in the range
+ */
+taa_UI_LINKAGE void taa_ui_calc_grid_range(
+    int numcols,
+    int cellh,
+    int spacing,
+    int originy,
+    int y,
+    int h,
+    int* begin_out,
+    int* end_out);
+
+/**
+ * @brief creates a ui context
+ * @details the stack, control, layout and text buffers are committed at the
+ * requested sizes, and reserve taa_UI_RESERVE_SCALE times as much address
+ * space. Buffers grow into the reservation as needed without moving, so
+ * the sizes only need to cover the common case.
+ */
 taa_UI_LINKAGE void taa_ui_create(
     size_t stacksize,
     size_t maxcontrols,
@@ -330,12 +636,70 @@ taa_UI_LINKAGE const taa_ui_controllist* taa_ui_end(
 taa_UI_LINKAGE unsigned int taa_ui_generate_id(
     taa_ui* ui);
 
+/**
+ * @brief gets the stable id of a control added during the current frame
+ */
+taa_UI_LINKAGE taa_ui_id taa_ui_get_id(
+    taa_ui* ui,
+    taa_ui_handle handle);
+
+/**
+ * @brief finds or creates the persistent state for a control id
+ * @details lookups are constant time. The returned pointer is only valid
+ * until taa_ui_end is called, as eviction may relocate states.
+ * @return the state, or NULL if the state table is full
+ */
+taa_UI_LINKAGE taa_ui_state* taa_ui_get_state(
+    taa_ui* ui,
+    taa_ui_id id);
+
+/**
+ * @brief reports the memory used by the buffers of the ui context
+ */
+taa_UI_LINKAGE void taa_ui_get_usage(
+    const taa_ui* ui,
+    taa_ui_usage* usage_out);
+
+/**
+ * @brief hashes a key with the path of the current parent into an id
+ */
+taa_UI_LINKAGE taa_ui_id taa_ui_hash_id(
+    taa_ui* ui,
+    const void* key,
+    size_t keylen);
+
 taa_UI_LINKAGE taa_ui_handle taa_ui_label(
     taa_ui* ui,
     taa_ui_styleid styleid,
     const taa_ui_rect* rect,
     const char* txt);
 
+/**
+ * @brief begins a memoized subtree
+ * @details if a subtree with the same key and content hash was added at
+ * the previous frame, its controls and layout are copied in bulk from the
+ * previous frame and the caller should skip adding them. The subtree is
+ * always rebuilt when it holds focus or when focus is about to move into
+ * it, so input is still processed. The content hash must change whenever
+ * anything that affects the controls in the subtree changes.
+ * @param ui the ui context
+ * @param key key unique among the memoized subtrees of the current parent
+ * @param contenthash hash of the content of the subtree
+ * @return nonzero if the caller must add the controls of the subtree, zero
+ *         if they were copied from the previous frame. In either case,
+ *         taa_ui_memo_end must be called afterward.
+ */
+taa_UI_LINKAGE int taa_ui_memo_begin(
+    taa_ui* ui,
+    unsigned int key,
+    uint32_t contenthash);
+
+/**
+ * @brief ends a memoized subtree begun with taa_ui_memo_begin
+ */
+taa_UI_LINKAGE void taa_ui_memo_end(
+    taa_ui* ui);
+
 /**
  * @brief a single line integer entry field
  */
@@ -349,6 +713,39 @@ taa_UI_LINKAGE taa_ui_handle taa_ui_numberbox(
     int* value,
     unsigned int* flags_out);
 
+/**
+ * @brief a block of text that is word wrapped to fit its width
+ * @details the text is broken into lines at spaces and newlines, and lines
+ * are broken between characters if a word does not fit. An auto sized
+ * width fits the longest line between newlines. With a fill width, the
+ * paragraph adds nothing to the auto width of its container, and an auto
+ * sized height is calculated from the width it is given by layout. The
+ * line breaks are cached by font, text and width, so unchanged paragraphs
+ * are not broken again each frame.
+ */
+taa_UI_LINKAGE taa_ui_handle taa_ui_paragraph(
+    taa_ui* ui,
+    taa_ui_styleid styleid,
+    const taa_ui_rect* rect,
+    const char* txt);
+
+/**
+ * @brief finds the control under a point, such as the mouse cursor
+ * @details the control is found the same way as the target of a mouse
+ * click: the last control in the list whose clip rect contains the point,
+ * ignoring labels, paragraphs and the ends of containers. The first few
+ * queries of a frame scan the whole list. Once a frame has been queried
+ * more often, its controls are indexed by a uniform grid over the view, so
+ * each later query only tests the controls in one cell.
+ * May be called after taa_ui_end and before the next taa_ui_begin.
+ * @return index of the control in the list returned by taa_ui_end, or -1
+ *         if there is none
+ */
+taa_UI_LINKAGE int taa_ui_pick(
+    taa_ui* ui,
+    int x,
+    int y);
+
 taa_UI_LINKAGE void taa_ui_pop_cols(
     taa_ui* ui);
 
@@ -358,6 +755,27 @@ taa_UI_LINKAGE taa_ui_handle taa_ui_pop_container(
     int* scrolly_out,
     unsigned int* flags_out);
 
+/**
+ * @brief ends a grid begun with taa_ui_push_grid
+ */
+taa_UI_LINKAGE void taa_ui_pop_grid(
+    taa_ui* ui);
+
+/**
+ * @brief ends a virtualized list begun with taa_ui_push_list
+ * @return handle to the list container, suitable as a scroll bar target
+ */
+taa_UI_LINKAGE taa_ui_handle taa_ui_pop_list(
+    taa_ui* ui,
+    int* scrolly_out,
+    unsigned int* flags_out);
+
+/**
+ * @brief ends an id scope begun with taa_ui_push_id
+ */
+taa_UI_LINKAGE void taa_ui_pop_id(
+    taa_ui* ui);
+
 taa_UI_LINKAGE void taa_ui_pop_rect(
     taa_ui* ui);
 
@@ -379,6 +797,72 @@ taa_UI_LINKAGE void taa_ui_push_container(
     int scrolly,
     unsigned int id);
 
+/**
+ * @brief begins a grid of uniformly sized cells
+ * @details each child added until the matching taa_ui_pop_grid is placed
+ * in the next cell, filling the rows from left to right. The rect of a
+ * child is relative to its cell and aligned within it as with
+ * taa_ui_push_rect. A fill width or height fills the cell.
+ * @param ui the ui context
+ * @param halign horizontal alignment of the children within their cells
+ * @param valign vertical alignment of the children within their cells
+ * @param spacing space between cells
+ * @param cellw width of every cell
+ * @param cellh height of every cell
+ * @param numcols number of cells in each row
+ * @param rect grid rectangle, relative to parent
+ */
+taa_UI_LINKAGE void taa_ui_push_grid(
+    taa_ui* ui,
+    taa_ui_halign halign,
+    taa_ui_valign valign,
+    int spacing,
+    int cellw,
+    int cellh,
+    int numcols,
+    const taa_ui_rect* rect);
+
+/**
+ * @brief begins an id scope
+ * @details the ids of all controls added until the matching taa_ui_pop_id
+ * are hashed with the key. This may be used to disambiguate siblings that
+ * would otherwise hash to the same id, such as rows of a list.
+ */
+taa_UI_LINKAGE void taa_ui_push_id(
+    taa_ui* ui,
+    unsigned int key);
+
+/**
+ * @brief begins a vertically scrolling list that only simulates the rows
+ *        that are visible
+ * @details the list is a container holding a row layout. Using the scroll
+ * value and the viewport height from the previous frame, the function
+ * determines the range of rows that intersect the viewport. The caller
+ * should only add controls for the rows in [begin_out, end_out), each of
+ * the height reported by the list, and then call taa_ui_pop_list. The
+ * height of the rows that were not added is synthesized so that scroll
+ * bars targeting the list still receive the full scroll range.
+ * @param ui the ui context
+ * @param styleid the style id to apply to the list container
+ * @param flags requested flags for the container
+ * @param rect list rectangle, relative to parent
+ * @param scrolly amount of vertical scroll
+ * @param id user id of the container
+ * @param list persistent list state owned by the caller
+ * @param begin_out index of the first row to add
+ * @param end_out index one past the last row to add
+ */
+taa_UI_LINKAGE void taa_ui_push_list(
+    taa_ui* ui,
+    taa_ui_styleid styleid,
+    unsigned int flags,
+    const taa_ui_rect* rect,
+    int scrolly,
+    unsigned int id,
+    taa_ui_list* list,
+    int* begin_out,
+    int* end_out);
+
 taa_UI_LINKAGE void taa_ui_push_rect(
     taa_ui* ui,
     taa_ui_halign halign,
@@ -391,6 +875,80 @@ taa_UI_LINKAGE void taa_ui_push_rows(
     int spacing,
     const taa_ui_rect* rect);
 
+/**
+ * @brief sets how many consecutive frames a buffer must use less than a
+ *        quarter of its committed memory before the excess is released
+ * @details zero, the default, never releases memory
+ */
+taa_UI_LINKAGE void taa_ui_set_decommit_frames(
+    taa_ui* ui,
+    unsigned int numframes);
+
+/**
+ * @brief sets a callback that draws the controls during layout
+ * @details taa_ui_end passes each control to the callback as soon as its
+ * rect and clip rect are final, so a draw list may be generated while the
+ * control is still in the cache, instead of walking the control list once
+ * layout is done. The begin control of a container is passed before its
+ * children and the end control after them, and siblings are passed in the
+ * order they were added. Controls culled by taa_UI_OPTION_CULL are not
+ * passed. The callback is not called if the control list is unchanged,
+ * so the draw list of the previous frame should be kept. While a callback
+ * is set, subtrees are not passed to the layout dispatch callback. A NULL
+ * callback, the default, disables it.
+ * @param ui the ui context
+ * @param func the draw callback, or NULL
+ * @param userdata pointer passed to the callback
+ */
+taa_UI_LINKAGE void taa_ui_set_draw_callback(
+    taa_ui* ui,
+    taa_ui_drawfunc func,
+    void* userdata);
+
+/**
+ * @brief sets a callback used to lay out large subtrees in parallel
+ * @details once every control has been sized, the placement of the
+ * descendants of a control only depends on the rect of the control. The
+ * descendants of each control with at least threshold layout commands
+ * beneath it, and no such control among them, are then placed by a
+ * separate task. The tasks of a frame are passed to the callback
+ * together, once the rest of the frame has been placed, and are complete
+ * before taa_ui_end processes the input. Subtrees placed by tasks are not
+ * matched individually by the layout cache. A NULL callback, the default,
+ * lays out the whole frame on the calling thread.
+ * @param ui the ui context
+ * @param func the dispatch callback, or NULL
+ * @param userdata pointer passed to the callback
+ * @param threshold minimum number of layout commands in a subtree
+ */
+taa_UI_LINKAGE void taa_ui_set_layout_dispatch(
+    taa_ui* ui,
+    taa_ui_dispatchfunc func,
+    void* userdata,
+    unsigned int threshold);
+
+/**
+ * @brief enables or disables optional behavior of the ui context
+ * @param ui the ui context
+ * @param options bitwise combination of taa_UI_OPTION flags
+ */
+taa_UI_LINKAGE void taa_ui_set_options(
+    taa_ui* ui,
+    unsigned int options);
+
+/**
+ * @brief adds the subtree recorded by a child context at the current
+ *        location of the parent
+ * @details the controls, layout and text of the child are copied into the
+ * parent and their indices are rebased. Both contexts must be idle on other
+ * threads. The child may be begun again once this returns.
+ * @param ui the parent context
+ * @param child the child context begun with taa_ui_begin_child
+ */
+taa_UI_LINKAGE void taa_ui_splice(
+    taa_ui* ui,
+    taa_ui* child);
+
 /**
  * @brief a single line text entry field
  */
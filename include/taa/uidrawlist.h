@@ -38,12 +38,17 @@ taa_UI_LINKAGE void taa_ui_add_drawlist_rect(
     const taa_vec2* uvlt,
     const taa_vec2* uvrb);
 
+/**
+ * @param txtw width of the text if already known, or negative to measure
+ *        it when the alignment requires it
+ */
 taa_UI_LINKAGE void taa_ui_add_drawlist_text(
     taa_ui_drawlist* drawlist,
     const taa_ui_font* font,
     uint32_t color,
     const char* txt,
     size_t txtlen,
+    int txtw,
     int x,
     int y,
     int w,
@@ -0,0 +1,80 @@
+/**
+ * @brief     ui input recording and playback header
+ * @details   A recorder captures the arguments passed to taa_ui_begin each
+ *            frame into a compact binary stream, and a player feeds them
+ *            back, so a session can be replayed exactly without a window.
+ *            Keyboard and mouse state are stored as run length encoded
+ *            differences from the previous frame, so idle frames cost a
+ *            single byte. Recordings store the input structures as raw
+ *            bytes, and may only be played back by builds that use the same
+ *            structure layout.
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#ifndef taa_UIREPLAY_H_
+#define taa_UIREPLAY_H_
+
+#include "ui.h"
+
+typedef struct taa_ui_player_s taa_ui_player;
+typedef struct taa_ui_recorder_s taa_ui_recorder;
+
+//****************************************************************************
+
+/**
+ * @brief creates a player for a recording
+ * @details the player references the recording, which must remain valid
+ * until the player is destroyed. If the recording is not valid for this
+ * build, the player plays zero frames.
+ */
+taa_UI_LINKAGE void taa_ui_create_player(
+    const void* data,
+    size_t size,
+    taa_ui_player** player_out);
+
+taa_UI_LINKAGE void taa_ui_create_recorder(
+    taa_ui_recorder** recorder_out);
+
+taa_UI_LINKAGE void taa_ui_destroy_player(
+    taa_ui_player* player);
+
+taa_UI_LINKAGE void taa_ui_destroy_recorder(
+    taa_ui_recorder* recorder);
+
+/**
+ * @brief gets the stream written by a recorder
+ * @details the pointer is valid until the next frame is recorded or the
+ * recorder is destroyed
+ */
+taa_UI_LINKAGE const void* taa_ui_get_recording(
+    const taa_ui_recorder* recorder,
+    size_t* size_out);
+
+/**
+ * @brief calls taa_ui_begin with the next recorded frame
+ * @return nonzero if a frame was begun, zero at the end of the recording
+ */
+taa_UI_LINKAGE int taa_ui_play_begin(
+    taa_ui_player* player,
+    taa_ui* ui);
+
+/**
+ * @brief appends the arguments for a call to taa_ui_begin to the recording
+ */
+taa_UI_LINKAGE void taa_ui_record_frame(
+    taa_ui_recorder* recorder,
+    int vieww,
+    int viewh,
+    const taa_keyboard_state* kb,
+    const taa_mouse_state* mouse,
+    const taa_window_event* winevents,
+    int numevents);
+
+/**
+ * @brief restarts playback from the first recorded frame
+ */
+taa_UI_LINKAGE void taa_ui_rewind_player(
+    taa_ui_player* player);
+
+#endif // taa_UIREPLAY_H_
@@ -95,6 +95,26 @@ taa_UI_LINKAGE void taa_ui_draw_visual_border(
     const taa_ui_rect* clip,
     taa_ui_drawlist* drawlist);
 
+/**
+ * @brief draws the lines of a paragraph, as broken by layout
+ * @details each line is aligned horizontally by the style. lines are
+ * stacked from the top of the content area, and only the lines that are
+ * visible within the clip rect are added to the draw list.
+ */
+taa_UI_LINKAGE void taa_ui_draw_visual_paragraph(
+    const taa_ui_style* style,
+    const taa_ui_visual* visual,
+    const taa_ui_rect* rect,
+    const taa_ui_rect* clip,
+    const char* text,
+    const taa_ui_textline* lines,
+    uint32_t numlines,
+    taa_ui_drawlist* drawlist);
+
+/**
+ * @param textwidth width of the text if already known, such as the width
+ *        measured by layout, or negative to measure it when required
+ */
 taa_UI_LINKAGE void taa_ui_draw_visual_text(
     const taa_ui_style* style,
     const taa_ui_visual* visual,
@@ -102,6 +122,7 @@ taa_UI_LINKAGE void taa_ui_draw_visual_text(
     const taa_ui_rect* clip,
     const char* text,
     uint32_t textlen,
+    int32_t textwidth,
     int32_t caret,
     uint32_t selectstart,
     uint32_t selectlength,
@@ -2,4 +2,5 @@
 #include "src/ui.c"
 #include "src/uidrawlist.c"
 #include "src/uirender.c"
+#include "src/uireplay.c"
 #include "src/uivisual.c"
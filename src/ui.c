@@ -4,15 +4,133 @@
  * @date      2011
  * @copyright unlicense / public domain
  ****************************************************************************/
+#include "uiarena.h"
+#include "uidamage.h"
+#include "uihash.h"
+#include "uiidle.h"
 #include "uiinput.h"
 #include "uilayout.h"
+#include "uipick.h"
 #include <taa/log.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 //****************************************************************************
+// macros
+
+/**
+ * the control, layout, text and stack regions reserve this many times the
+ * initial size passed to taa_ui_create as address space, and commit memory
+ * as they grow
+ */
+#ifndef taa_UI_RESERVE_SCALE
+#define taa_UI_RESERVE_SCALE 64
+#endif
+
+//****************************************************************************
+enum
+{
+    /// maximum number of virtualized lists per frame
+    taa_UI_MAX_LISTS = 32,
+    /// maximum nesting of memoized subtrees
+    taa_UI_MAX_MEMO_DEPTH = 16,
+    /// number of control types that keep separate sibling ordinals
+    taa_UI_NUM_ORDINALS = 8,
+    /// number of frames a state may go unaccessed before it is evicted
+    taa_UI_STATE_MAX_AGE = 120,
+    /// number of state table slots examined for eviction each frame
+    taa_UI_STATE_SWEEP = 64
+};
+
+typedef struct taa_ui_identry_s taa_ui_identry;
+typedef struct taa_ui_idset_s taa_ui_idset;
+typedef struct taa_ui_internentry_s taa_ui_internentry;
+typedef struct taa_ui_listref_s taa_ui_listref;
+typedef struct taa_ui_memo_s taa_ui_memo;
+typedef struct taa_ui_memoarena_s taa_ui_memoarena;
+typedef struct taa_ui_memoscope_s taa_ui_memoscope;
 typedef struct taa_ui_stack_s taa_ui_stack;
+typedef struct taa_ui_textintern_s taa_ui_textintern;
+
+struct taa_ui_identry_s
+{
+    taa_ui_id id;
+    uint32_t frame;
+};
+
+// ids claimed by the controls of the current frame, open addressed by id.
+// entries claimed at earlier frames count as empty, so the set is emptied
+// every frame by advancing the frame counter
+struct taa_ui_idset_s
+{
+    taa_ui_identry* entries;
+    size_t count;
+    size_t capacity;
+    uint32_t frame;
+};
+
+struct taa_ui_internentry_s
+{
+    uint32_t hash;
+    uint32_t length;
+    uint32_t offset;
+};
+
+struct taa_ui_listref_s
+{
+    taa_ui_list* list;
+    int layoutcmd;
+};
+
+struct taa_ui_memo_s
+{
+    taa_ui_id id;
+    uint32_t hash;
+    // id of the parent path and the sibling ordinals of the parent scope
+    // before and after the subtree was added. the ids of the controls in
+    // the subtree are only valid if the path and starting ordinals match
+    taa_ui_id pathid;
+    int beginordinals[taa_UI_NUM_ORDINALS];
+    int endordinals[taa_UI_NUM_ORDINALS];
+    // location of the copied commands and controls within the arena
+    int cmdoffset;
+    int ctrloffset;
+    int numcmds;
+    int numctrls;
+    // first layout command and lowest control index of the subtree at the
+    // frame it was recorded, used to rebase indices when it is replayed
+    int cmdbase;
+    int ctrlbase;
+};
+
+struct taa_ui_memoarena_s
+{
+    taa_uiarena memoregion;
+    taa_uiarena cmdregion;
+    taa_uiarena ctrlregion;
+    taa_uiarena textregion;
+    taa_ui_memo* memos;
+    taa_uilayout_cmd* cmds;
+    taa_ui_control* ctrls;
+    char* text;
+    size_t nummemos;
+    size_t numcmds;
+    size_t numctrls;
+    size_t textsize;
+};
+
+struct taa_ui_memoscope_s
+{
+    taa_ui_id id;
+    uint32_t hash;
+    size_t stackdepth;
+    size_t numlists;
+    int cmdbegin;
+    int ctrlbegin;
+    int replayed;
+    int ordinals[taa_UI_NUM_ORDINALS];
+};
 
 struct taa_ui_stack_s
 {
@@ -20,6 +138,26 @@ struct taa_ui_stack_s
     int layoutcmd;
     int scrollx;
     int scrolly;
+    taa_ui_list* list;
+    // id of the path to this stack entry and the index of the stack entry
+    // that tracks sibling ordinals. pure layout entries share the scope of
+    // their parent, so inserting a row or column does not change ids
+    taa_ui_id id;
+    int idscope;
+    int ordinals[taa_UI_NUM_ORDINALS];
+};
+
+struct taa_ui_textintern_s
+{
+    // open addressed by the hash of the text. a zero length marks an empty
+    // slot, since empty strings are never interned
+    taa_ui_internentry* entries;
+    size_t count;
+    size_t capacity;
+    char* text;
+    size_t textsize;
+    size_t textcapacity;
+    int isfull;
 };
 
 struct taa_ui_s
@@ -35,27 +173,211 @@ struct taa_ui_s
     int viewheight;
     int ctrlcursor;
     unsigned int idcounter;
+    unsigned int options;
+    // persistent control state, open addressed by id
+    taa_ui_state* states;
+    size_t statecapacity;
+    size_t statesweep;
+    uint32_t frame;
     // control buffers
     size_t numstyles;
     size_t stackdepth;
+    size_t maxstackdepth;
+    size_t stackoverflow;
     size_t textoffset;
     size_t stackcapacity;
     size_t ctrlcapacity;
     size_t textcapacity;
     char* textbuffer;
+    // reserved regions backing the buffers
+    taa_uiarena stackarena;
+    taa_uiarena ctrlarena;
+    taa_uiarena layoutarena;
+    taa_uiarena textarena;
+    unsigned int decommitframes;
     taa_ui_controllist ctrllist;
+    // virtualized lists that need their viewport measured after layout
+    size_t numlists;
+    taa_ui_listref lists[taa_UI_MAX_LISTS];
+    // memoized subtrees recorded at the current and previous frames. the
+    // arenas alternate each frame and are reserved on first use
+    taa_ui_memoarena memoarenas[2];
+    size_t memodepth;
+    taa_ui_memoscope memostack[taa_UI_MAX_MEMO_DEPTH];
+    // copy of the previous frame used to calculate damage rectangles,
+    // allocated when the option is enabled
+    taa_uidamage_state damage;
+    // stream hash and layout results used to detect idle frames
+    taa_uiidle_state idle;
+    // strings shared across frames, allocated when the option is enabled
+    taa_ui_textintern intern;
+    // point query index over the controls, built on first use each frame
+    taa_uipick_grid pick;
+    // ids of the keyed controls of the frame, used to tell repeats apart
+    taa_ui_idset ids;
 };
 
+//****************************************************************************
+static const char* taa_ui_intern_text(
+    taa_ui* ui,
+    const char* txt,
+    size_t txtlen)
+{
+    const char* result = NULL;
+    taa_ui_textintern* intern = &ui->intern;
+    if(intern->entries != NULL && txtlen > 0)
+    {
+        uint32_t hash = taa_uihash_add(taa_UIHASH_BASIS, txt, txtlen);
+        size_t mask = intern->capacity - 1;
+        size_t i = hash & mask;
+        size_t n = 0;
+        // linear probe until the string or an empty slot is found
+        while(n <= mask)
+        {
+            taa_ui_internentry* e = intern->entries + i;
+            if(e->length == 0)
+            {
+                // store the string if there is room. the table is kept at
+                // most half full to keep probe sequences short. once the
+                // table or the buffer is full, it is flushed at the next
+                // frame
+                size_t textsize = intern->textsize + txtlen;
+                if(intern->count*2 < intern->capacity &&
+                   textsize <= intern->textcapacity)
+                {
+                    char* dst = intern->text + intern->textsize;
+                    memcpy(dst, txt, txtlen);
+                    e->hash = hash;
+                    e->length = (uint32_t) txtlen;
+                    e->offset = (uint32_t) intern->textsize;
+                    intern->textsize = textsize;
+                    ++intern->count;
+                    result = dst;
+                }
+                else
+                {
+                    intern->isfull = 1;
+                }
+                break;
+            }
+            if(e->hash == hash &&
+               e->length == txtlen &&
+               !memcmp(intern->text + e->offset, txt, txtlen))
+            {
+                result = intern->text + e->offset;
+                break;
+            }
+            i = (i + 1) & mask;
+            ++n;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+static int taa_ui_reserve_controls(
+    taa_ui* ui,
+    int count)
+{
+    // the control buffer is filled in reverse order, so its region is
+    // committed from the end down
+    size_t needed = ui->ctrlcapacity - (ui->ctrlcursor + 1) + count;
+    return
+        ui->ctrlcursor + 1 >= count &&
+        taa_uiarena_ensure(&ui->ctrlarena, needed);
+}
+
+//****************************************************************************
+static int taa_ui_reserve_layout(
+    taa_ui* ui,
+    size_t count)
+{
+    int result = taa_uiarena_ensure(&ui->layoutarena, ui->layout.size+count);
+    ui->layout.capacity = ui->layoutarena.numcommitted;
+    return result;
+}
+
+//****************************************************************************
+static int taa_ui_reserve_stack(
+    taa_ui* ui,
+    size_t count,
+    int numcontrols)
+{
+    // once the stack overflows, every push is discarded until the matching
+    // pops, so pushes and pops remain balanced. containers also reserve
+    // their begin and end controls, so they are never left unpaired
+    int result = ui->stackoverflow == 0;
+    if(result && !taa_uiarena_ensure(&ui->stackarena,ui->stackdepth+1+count))
+    {
+        taa_LOG_WARN("exceeded ui stack limit");
+        result = 0;
+    }
+    if(result && !taa_ui_reserve_controls(ui, numcontrols))
+    {
+        taa_LOG_WARN("exceeded ui control limit");
+        result = 0;
+    }
+    if(!result)
+    {
+        ++ui->stackoverflow;
+    }
+    return result;
+}
+
+//****************************************************************************
+static int taa_ui_push_layout(
+    taa_ui* ui,
+    taa_uilayout_mode mode,
+    taa_ui_halign halign,
+    taa_ui_valign valign,
+    int spacing,
+    int parent,
+    int targetcmd,
+    int control,
+    int scrollx,
+    int scrolly,
+    const taa_ui_rect* rect)
+{
+    taa_ui_reserve_layout(ui, 1);
+    return taa_uilayout_push(
+        &ui->layout,
+        mode,
+        halign,
+        valign,
+        spacing,
+        parent,
+        targetcmd,
+        control,
+        scrollx,
+        scrolly,
+        rect);
+}
+
+//****************************************************************************
+static void taa_ui_pop_layout(
+    taa_ui* ui,
+    int cmdindex,
+    int control)
+{
+    taa_uilayout_pop(&ui->layout, cmdindex, control);
+    if(cmdindex >= 0 && (ui->options & taa_UI_OPTION_IDLE) != 0)
+    {
+        // the command is complete once it is popped
+        taa_uiidle_add_cmd(&ui->idle, ui->layout.cmds + cmdindex);
+    }
+}
+
 //****************************************************************************
 static int taa_ui_push_id_control(
     taa_ui* ui,
     taa_ui_type type,
     taa_ui_styleid styleid,
     unsigned int flags,
+    taa_ui_id ctrlid,
     unsigned int id)
 {
     int index = -1;
-    if(ui->ctrlcursor >= 0)
+    if(taa_ui_reserve_controls(ui, 1))
     {
         taa_ui_control* ctrl;
         index = ui->ctrlcursor;
@@ -63,8 +385,14 @@ static int taa_ui_push_id_control(
         ctrl->type = type;
         ctrl->styleid = styleid;
         ctrl->flags = flags;
+        ctrl->id = ctrlid;
         ctrl->data.type = taa_UI_DATA_ID;
         ctrl->data.id.id = id;
+        ctrl->data.id.numdescendants = 0;
+        if((ui->options & taa_UI_OPTION_IDLE) != 0)
+        {
+            taa_uiidle_add_control(&ui->idle, ctrl);
+        }
         --ui->ctrlcursor;
     }
     else
@@ -81,11 +409,12 @@ static int taa_ui_push_range_control(
     taa_ui_styleid panestyleid,
     taa_ui_styleid sliderstyleid,
     unsigned int flags,
+    taa_ui_id ctrlid,
     int range,
     int value)
 {
     int index = -1;
-    if(ui->ctrlcursor >= 0)
+    if(taa_ui_reserve_controls(ui, 1))
     {
         taa_ui_control* ctrl;
         index = ui->ctrlcursor;
@@ -93,10 +422,15 @@ static int taa_ui_push_range_control(
         ctrl->type = type;
         ctrl->styleid = panestyleid;
         ctrl->flags = flags;
+        ctrl->id = ctrlid;
         ctrl->data.type = taa_UI_DATA_SCROLL;
         ctrl->data.scroll.sliderstyleid = sliderstyleid;
         ctrl->data.scroll.range = range;
         ctrl->data.scroll.value = value;
+        if((ui->options & taa_UI_OPTION_IDLE) != 0)
+        {
+            taa_uiidle_add_control(&ui->idle, ctrl);
+        }
         --ui->ctrlcursor;
     }
     else
@@ -112,34 +446,59 @@ static int taa_ui_push_text_control(
     taa_ui_type type,
     taa_ui_styleid styleid,
     unsigned int flags,
+    taa_ui_id ctrlid,
     const char* txt,
     size_t txtlen,
-    size_t txtcapacity)
+    size_t txtcapacity,
+    int isconst)
 {
     int index = -1;
-    if(ui->ctrlcursor >= 0)
+    if(taa_ui_reserve_controls(ui, 1))
     {
         taa_ui_control* ctrl;
-        char* dsttxt;
-        size_t maxtxt;
-        maxtxt = ui->textcapacity - ui->textoffset;
-        if(txtlen > maxtxt)
+        const char* dsttxt = NULL;
+        if(isconst && (ui->options & taa_UI_OPTION_STATIC_TEXT) != 0)
         {
-            txtlen = maxtxt;
-            taa_LOG_WARN("exceeded ui text limit");
+            // the caller guarantees the text outlives the frame
+            dsttxt = txt;
+        }
+        else if(isconst && (ui->options & taa_UI_OPTION_INTERN_TEXT) != 0)
+        {
+            dsttxt = taa_ui_intern_text(ui, txt, txtlen);
+        }
+        if(dsttxt == NULL)
+        {
+            char* buftxt;
+            size_t maxtxt;
+            taa_uiarena_ensure(&ui->textarena, ui->textoffset + txtlen);
+            maxtxt = ui->textarena.numcommitted - ui->textoffset;
+            if(txtlen > maxtxt)
+            {
+                txtlen = maxtxt;
+                taa_LOG_WARN("exceeded ui text limit");
+            }
+            buftxt = ui->textbuffer + ui->textoffset;
+            memcpy(buftxt, txt, txtlen);
+            ui->textoffset += txtlen;
+            dsttxt = buftxt;
         }
-        dsttxt = ui->textbuffer + ui->textoffset;
-        memcpy(dsttxt, txt, txtlen);
         index = ui->ctrlcursor;
         ctrl = ui->ctrlbuffer + index;
         ctrl->type = type;
         ctrl->styleid = styleid;
         ctrl->flags = flags;
+        ctrl->id = ctrlid;
         ctrl->data.type = taa_UI_DATA_TEXT;
         ctrl->data.text.text = dsttxt;
         ctrl->data.text.textlength = txtlen;
         ctrl->data.text.textcapacity = txtcapacity;
-        ui->textoffset += txtlen;
+        ctrl->data.text.textwidth = -1;
+        ctrl->data.text.numlines = 0;
+        ctrl->data.text.lines = NULL;
+        if((ui->options & taa_UI_OPTION_IDLE) != 0)
+        {
+            taa_uiidle_add_control(&ui->idle, ctrl);
+        }
         --ui->ctrlcursor;
     }
     else
@@ -155,18 +514,30 @@ static int32_t taa_ui_push_stack(
     int32_t control,
     int32_t layoutcmd,
     int32_t scrollx,
-    int32_t scrolly)
+    int32_t scrolly,
+    taa_ui_id id,
+    int isscope)
 {
     uint32_t index = ui->stackdepth + 1;
-    if(index < ui->stackcapacity)
+    taa_ui_stack* s = ui->stack + index;
+    // callers reserve the stack before pushing
+    assert(index < ui->stackarena.numcommitted);
+    s->control = control;
+    s->layoutcmd = layoutcmd;
+    s->scrollx = scrollx;
+    s->scrolly = scrolly;
+    s->list = NULL;
+    s->id = id;
+    s->idscope = (isscope) ? (int) index : (s - 1)->idscope;
+    if(isscope)
     {
-        taa_ui_stack* s = ui->stack + index;
-        s->control = control;
-        s->layoutcmd = layoutcmd;
-        s->scrollx = scrollx;
-        s->scrolly = scrolly;
+        memset(s->ordinals, 0, sizeof(s->ordinals));
     }
     ++ui->stackdepth;
+    if(ui->stackdepth > ui->maxstackdepth)
+    {
+        ui->maxstackdepth = ui->stackdepth;
+    }
     return index;
 }
 
@@ -179,23 +550,647 @@ static void taa_ui_pop_stack(
 }
 
 //****************************************************************************
-void taa_ui_begin(
+static int taa_ui_pop_overflow(
+    taa_ui* ui)
+{
+    // returns nonzero if the pop matches a push that overflowed the stack
+    int result = ui->stackoverflow > 0;
+    if(result)
+    {
+        --ui->stackoverflow;
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief claims an id for the current frame
+ * @return zero if the id was already claimed during the frame
+ */
+static int taa_ui_claim_id(
+    taa_ui* ui,
+    taa_ui_id id)
+{
+    taa_ui_idset* set = &ui->ids;
+    int result = 1;
+    size_t mask;
+    size_t i;
+    if(set->frame != ui->frame)
+    {
+        set->frame = ui->frame;
+        set->count = 0;
+    }
+    if((set->count + 1) * 2 > set->capacity)
+    {
+        // grow the table, keeping only the ids of the current frame
+        taa_ui_identry* src = set->entries;
+        size_t srccapacity = set->capacity;
+        size_t capacity = (srccapacity > 0) ? srccapacity * 2 : 256;
+        taa_ui_identry* entries;
+        entries = (taa_ui_identry*) calloc(capacity, sizeof(*entries));
+        if(entries != NULL)
+        {
+            size_t j;
+            set->entries = entries;
+            set->capacity = capacity;
+            for(j = 0; j < srccapacity; ++j)
+            {
+                if(src[j].id != 0 && src[j].frame == set->frame)
+                {
+                    i = src[j].id & (capacity - 1);
+                    while(entries[i].id != 0)
+                    {
+                        i = (i + 1) & (capacity - 1);
+                    }
+                    entries[i] = src[j];
+                }
+            }
+            free(src);
+        }
+    }
+    if((set->count + 1) * 2 <= set->capacity)
+    {
+        mask = set->capacity - 1;
+        i = id & mask;
+        while(set->entries[i].id != 0 && set->entries[i].frame == set->frame)
+        {
+            if(set->entries[i].id == id)
+            {
+                result = 0;
+                break;
+            }
+            i = (i + 1) & mask;
+        }
+        if(result)
+        {
+            set->entries[i].id = id;
+            set->entries[i].frame = set->frame;
+            ++set->count;
+        }
+    }
+    else
+    {
+        taa_LOG_WARN("failed to allocate ui id set");
+    }
+    return result;
+}
+
+//****************************************************************************
+static taa_ui_id taa_ui_calc_id(
+    taa_ui* ui,
+    taa_ui_type type,
+    const void* key,
+    size_t keylen)
+{
+    const taa_ui_stack* p = ui->stack + ui->stackdepth;
+    taa_ui_id id = taa_uihash_add(p->id, &type, sizeof(type));
+    if(key != NULL)
+    {
+        // siblings may share a key, such as two buttons with the same
+        // caption. a repeat is identified by its order among the siblings
+        // with the same key, so its id is hashed again until it is unique
+        taa_ui_id keyid = taa_uihash_add(id, key, keylen);
+        int repeat = 0;
+        id = (keyid != 0) ? keyid : 1;
+        while(!taa_ui_claim_id(ui, id))
+        {
+            ++repeat;
+            id = taa_uihash_add(keyid, &repeat, sizeof(repeat));
+            id = (id != 0) ? id : 1;
+        }
+    }
+    else
+    {
+        // without a key, the control is identified by its order among the
+        // siblings of the same type
+        taa_ui_stack* scope = ui->stack + p->idscope;
+        int ordinal = scope->ordinals[type % taa_UI_NUM_ORDINALS]++;
+        id = taa_uihash_add(id, &ordinal, sizeof(ordinal));
+    }
+    return (id != 0) ? id : 1;
+}
+
+//****************************************************************************
+static taa_ui_state* taa_ui_find_state(
+    taa_ui* ui,
+    taa_ui_id id,
+    int create)
+{
+    taa_ui_state* result = NULL;
+    size_t mask = ui->statecapacity - 1;
+    size_t i = id & mask;
+    size_t n = 0;
+    // linear probe until the id or an empty slot is found
+    while(n <= mask)
+    {
+        taa_ui_state* st = ui->states + i;
+        if(st->id == id)
+        {
+            result = st;
+            break;
+        }
+        if(st->id == 0)
+        {
+            if(create)
+            {
+                memset(st, 0, sizeof(*st));
+                st->id = id;
+                result = st;
+            }
+            break;
+        }
+        i = (i + 1) & mask;
+        ++n;
+    }
+    if(result != NULL)
+    {
+        result->frame = ui->frame;
+    }
+    else if(create)
+    {
+        taa_LOG_WARN("exceeded ui state limit");
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief marks the state of a control as used this frame, if it has one,
+ * so that it is not evicted while the control still exists
+ */
+static void taa_ui_keep_state(
+    taa_ui* ui,
+    taa_ui_id id)
+{
+    taa_ui_find_state(ui, id, 0);
+}
+
+//****************************************************************************
+static void taa_ui_sweep_states(
+    taa_ui* ui)
+{
+    // incrementally evict states that have not been accessed recently. the
+    // slot is deleted by shifting subsequent entries of the probe sequence
+    // back, so no tombstones are needed and lookups stay short
+    size_t mask = ui->statecapacity - 1;
+    size_t i = ui->statesweep;
+    size_t n = (taa_UI_STATE_SWEEP < ui->statecapacity) ?
+        taa_UI_STATE_SWEEP :
+        ui->statecapacity;
+    while(n > 0)
+    {
+        taa_ui_state* st = ui->states + i;
+        if(st->id != 0 && (ui->frame - st->frame) > taa_UI_STATE_MAX_AGE)
+        {
+            size_t hole = i;
+            size_t j = (i + 1) & mask;
+            while(ui->states[j].id != 0)
+            {
+                size_t home = ui->states[j].id & mask;
+                // move the entry into the hole if its home slot does not
+                // lie cyclically within (hole, j]
+                int inrange = (hole <= j) ?
+                    (home > hole && home <= j) :
+                    (home > hole || home <= j);
+                if(!inrange)
+                {
+                    ui->states[hole] = ui->states[j];
+                    hole = j;
+                }
+                j = (j + 1) & mask;
+            }
+            ui->states[hole].id = 0;
+            // re-examine the current slot, since an entry may have moved
+            // into it
+            if(hole != i)
+            {
+                continue;
+            }
+        }
+        i = (i + 1) & mask;
+        --n;
+    }
+    ui->statesweep = i;
+}
+
+//****************************************************************************
+static int taa_ui_list_item_height(
+    const taa_ui_list* list,
+    int item)
+{
+    int h = list->itemheight;
+    if(list->heightfunc != NULL)
+    {
+        h = list->heightfunc(list->userdata, item);
+    }
+    return h + list->spacing;
+}
+
+//****************************************************************************
+static void taa_ui_calc_list_range(
+    taa_ui_list* list,
+    int scrolly,
+    int viewh,
+    int* begin_out,
+    int* end_out,
+    int* y_out)
+{
+    int numitems = (list->numitems > 0) ? list->numitems : 0;
+    int begin = 0;
+    int end = 0;
+    int y = 0;
+    if(scrolly < 0)
+    {
+        scrolly = 0;
+    }
+    if(list->heightfunc == NULL)
+    {
+        // fixed height rows can be located arithmetically
+        int rowh = list->itemheight + list->spacing;
+        if(rowh > 0)
+        {
+            begin = scrolly / rowh;
+            end = (scrolly + viewh + rowh - 1) / rowh;
+            begin = (begin < numitems) ? begin : numitems;
+            end = (end < numitems) ? end : numitems;
+            y = begin * rowh;
+        }
+        else
+        {
+            end = numitems;
+        }
+        list->contenth = numitems * rowh;
+        if(numitems > 0)
+        {
+            // spacing only exists between rows
+            list->contenth -= list->spacing;
+        }
+    }
+    else
+    {
+        int anchor;
+        int anchory;
+        int bottom;
+        if(list->contenth < 0 || list->measureditems != numitems)
+        {
+            // the total height is only measured when the number of items
+            // changes or the caller invalidates it
+            int i;
+            list->contenth = 0;
+            for(i = 0; i < numitems; ++i)
+            {
+                list->contenth += taa_ui_list_item_height(list, i);
+            }
+            if(numitems > 0)
+            {
+                list->contenth -= list->spacing;
+            }
+            list->measureditems = numitems;
+            list->anchoritem = 0;
+            list->anchory = 0;
+        }
+        // walk from the first visible row of the previous frame, so the
+        // cost is proportional to the scroll distance instead of the size
+        // of the list
+        anchor = list->anchoritem;
+        anchory = list->anchory;
+        while(anchor > 0 && anchory > scrolly)
+        {
+            --anchor;
+            anchory -= taa_ui_list_item_height(list, anchor);
+        }
+        while(anchor < numitems - 1)
+        {
+            int h = taa_ui_list_item_height(list, anchor);
+            if(anchory + h > scrolly)
+            {
+                break;
+            }
+            anchory += h;
+            ++anchor;
+        }
+        if(anchor >= numitems)
+        {
+            anchor = 0;
+            anchory = 0;
+        }
+        list->anchoritem = anchor;
+        list->anchory = anchory;
+        begin = anchor;
+        end = anchor;
+        y = anchory;
+        bottom = anchory;
+        while(end < numitems && bottom < scrolly + viewh)
+        {
+            bottom += taa_ui_list_item_height(list, end);
+            ++end;
+        }
+    }
+    *begin_out = begin;
+    *end_out = end;
+    *y_out = y;
+}
+
+//****************************************************************************
+static int taa_ui_alloc_memo(
+    taa_ui* ui)
+{
+    if(ui->memoarenas[0].memos == NULL)
+    {
+        taa_ui_memoarena* arenaitr = ui->memoarenas;
+        taa_ui_memoarena* arenaend = arenaitr + 2;
+        // memory is only committed as subtrees are recorded
+        while(arenaitr != arenaend)
+        {
+            taa_uiarena_create(
+                &arenaitr->memoregion,
+                sizeof(*arenaitr->memos),
+                ui->ctrlcapacity,
+                0,
+                0);
+            taa_uiarena_create(
+                &arenaitr->cmdregion,
+                sizeof(*arenaitr->cmds),
+                ui->layoutarena.capacity,
+                0,
+                0);
+            taa_uiarena_create(
+                &arenaitr->ctrlregion,
+                sizeof(*arenaitr->ctrls),
+                ui->ctrlcapacity,
+                0,
+                0);
+            taa_uiarena_create(
+                &arenaitr->textregion,
+                sizeof(*arenaitr->text),
+                ui->textcapacity,
+                0,
+                0);
+            arenaitr->memos = (taa_ui_memo*) arenaitr->memoregion.elems;
+            arenaitr->cmds = (taa_uilayout_cmd*) arenaitr->cmdregion.elems;
+            arenaitr->ctrls = (taa_ui_control*) arenaitr->ctrlregion.elems;
+            arenaitr->text = (char*) arenaitr->textregion.elems;
+            arenaitr->nummemos = 0;
+            arenaitr->numcmds = 0;
+            arenaitr->numctrls = 0;
+            arenaitr->textsize = 0;
+            ++arenaitr;
+        }
+    }
+    return ui->memoarenas[0].memos != NULL;
+}
+
+//****************************************************************************
+static int taa_ui_store_memo(
+    taa_ui_memoarena* arena,
+    const taa_ui_memo* memo,
+    const taa_uilayout_cmd* cmds,
+    const taa_ui_control* ctrls)
+{
+    int index = -1;
+    size_t textsize = 0;
+    const taa_ui_control* ctrlitr = ctrls;
+    const taa_ui_control* ctrlend = ctrls + memo->numctrls;
+    while(ctrlitr != ctrlend)
+    {
+        if(ctrlitr->data.type == taa_UI_DATA_TEXT)
+        {
+            textsize += ctrlitr->data.text.textlength;
+        }
+        ++ctrlitr;
+    }
+    if(taa_uiarena_ensure(&arena->memoregion, arena->nummemos + 1) &&
+       taa_uiarena_ensure(&arena->cmdregion,arena->numcmds+memo->numcmds) &&
+       taa_uiarena_ensure(&arena->ctrlregion,arena->numctrls+memo->numctrls)&&
+       taa_uiarena_ensure(&arena->textregion, arena->textsize + textsize))
+    {
+        taa_ui_memo* dst = arena->memos + arena->nummemos;
+        taa_ui_control* dstctrl;
+        taa_ui_control* dstend;
+        *dst = *memo;
+        dst->cmdoffset = arena->numcmds;
+        dst->ctrloffset = arena->numctrls;
+        memcpy(arena->cmds+arena->numcmds, cmds, memo->numcmds*sizeof(*cmds));
+        dstctrl = arena->ctrls + arena->numctrls;
+        dstend = dstctrl + memo->numctrls;
+        memcpy(dstctrl, ctrls, memo->numctrls * sizeof(*ctrls));
+        // the text of the controls may live in the frame text buffer, which
+        // is reset every frame, so it is copied into the arena as well
+        while(dstctrl != dstend)
+        {
+            if(dstctrl->data.type == taa_UI_DATA_TEXT)
+            {
+                char* dsttxt = arena->text + arena->textsize;
+                size_t txtlen = dstctrl->data.text.textlength;
+                memcpy(dsttxt, dstctrl->data.text.text, txtlen);
+                dstctrl->data.text.text = dsttxt;
+                arena->textsize += txtlen;
+            }
+            ++dstctrl;
+        }
+        index = (int) arena->nummemos;
+        arena->numcmds += memo->numcmds;
+        arena->numctrls += memo->numctrls;
+        ++arena->nummemos;
+    }
+    else
+    {
+        taa_LOG_WARN("exceeded ui memo limit");
+    }
+    return index;
+}
+
+//****************************************************************************
+static int taa_ui_test_memo(
+    taa_ui* ui,
+    const taa_ui_memoarena* arena,
+    const taa_ui_memo* memo,
+    const taa_ui_memoscope* ms)
+{
+    int result = 0;
+    if(memo->id == ms->id &&
+       memo->hash == ms->hash &&
+       memo->pathid == ui->stack[ui->stackdepth].id &&
+       !memcmp(memo->beginordinals, ms->ordinals, sizeof(ms->ordinals)) &&
+       taa_ui_reserve_layout(ui, memo->numcmds) &&
+       taa_ui_reserve_controls(ui, memo->numctrls))
+    {
+        // the subtree must be rebuilt if focus moved into it at the end of
+        // the previous frame, so the focused control can process input
+        const taa_ui_control* ctrlitr = arena->ctrls + memo->ctrloffset;
+        const taa_ui_control* ctrlend = ctrlitr + memo->numctrls;
+        taa_ui_id focusid = ui->prevstate.focusid;
+        result = 1;
+        while(ctrlitr != ctrlend)
+        {
+            if(focusid != 0 && ctrlitr->id == focusid)
+            {
+                result = 0;
+                break;
+            }
+            ++ctrlitr;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+static void taa_ui_append_stream(
+    taa_ui* ui,
+    const taa_uilayout_cmd* cmds,
+    int numcmds,
+    int cmdbase,
+    const taa_ui_control* ctrls,
+    int numctrls,
+    int ctrlbase)
+{
+    const taa_ui_stack* p = ui->stack + ui->stackdepth;
+    const taa_uilayout_cmd* srcitr = cmds;
+    const taa_uilayout_cmd* srcend = srcitr + numcmds;
+    taa_uilayout_cmd* dstcmd = ui->layout.cmds + ui->layout.size;
+    int cmddelta = ((int) ui->layout.size) - cmdbase;
+    int ctrlbegin = ui->ctrlcursor + 1 - numctrls;
+    int ctrldelta = ctrlbegin - ctrlbase;
+    // the controls are stored in the same reverse order they were added,
+    // so the whole range can be copied below the control cursor at once
+    memcpy(
+        ui->ctrlbuffer + ctrlbegin,
+        ctrls,
+        numctrls * sizeof(*ui->ctrlbuffer));
+    while(srcitr != srcend)
+    {
+        *dstcmd = *srcitr;
+        // commands that were children of the parent outside the subtree are
+        // attached to the current parent
+        dstcmd->parentcmd = (srcitr->parentcmd >= cmdbase) ?
+            srcitr->parentcmd + cmddelta :
+            p->layoutcmd;
+        if(srcitr->targetcmd >= 0)
+        {
+            dstcmd->targetcmd += cmddelta;
+        }
+        dstcmd->childbegin += cmddelta;
+        dstcmd->childend += cmddelta;
+        if(srcitr->control0 >= 0)
+        {
+            dstcmd->control0 += ctrldelta;
+        }
+        if(srcitr->control1 >= 0)
+        {
+            dstcmd->control1 += ctrldelta;
+        }
+        ++srcitr;
+        ++dstcmd;
+    }
+    ui->layout.size += numcmds;
+    ui->ctrlcursor -= numctrls;
+}
+
+//****************************************************************************
+static void taa_ui_replay_memo(
+    taa_ui* ui,
+    const taa_ui_memoarena* arena,
+    const taa_ui_memo* memo)
+{
+    const taa_ui_control* ctrlitr;
+    const taa_ui_control* ctrlend;
+    if((ui->options & taa_UI_OPTION_IDLE) != 0)
+    {
+        // a replayed subtree is a copy of the same record every frame, so
+        // the record and where it was placed stand in for its contents
+        const taa_ui_stack* p = ui->stack + ui->stackdepth;
+        taa_uiidle_add(&ui->idle, &memo->id, sizeof(memo->id));
+        taa_uiidle_add(&ui->idle, &memo->hash, sizeof(memo->hash));
+        taa_uiidle_add_int(&ui->idle, memo->numcmds);
+        taa_uiidle_add_int(&ui->idle, memo->numctrls);
+        taa_uiidle_add_int(&ui->idle, (int) ui->layout.size);
+        taa_uiidle_add_int(&ui->idle, ui->ctrlcursor);
+        taa_uiidle_add_int(&ui->idle, p->layoutcmd);
+    }
+    taa_ui_append_stream(
+        ui,
+        arena->cmds + memo->cmdoffset,
+        memo->numcmds,
+        memo->cmdbase,
+        arena->ctrls + memo->ctrloffset,
+        memo->numctrls,
+        memo->ctrlbase);
+    // claim the ids of the keyed controls in the subtree, so repeats of
+    // their keys added later in the frame are still told apart. a replayed
+    // paragraph needs the wrapping passes as much as an added one
+    ctrlitr = ui->ctrlbuffer + ui->ctrlcursor + 1;
+    ctrlend = ctrlitr + memo->numctrls;
+    while(ctrlitr != ctrlend)
+    {
+        if(ctrlitr->type == taa_UI_BUTTON ||
+           ctrlitr->type == taa_UI_CONTAINER_BEGIN)
+        {
+            taa_ui_claim_id(ui, ctrlitr->id);
+        }
+        else if(ctrlitr->type == taa_UI_PARAGRAPH)
+        {
+            ui->layout.iswrapping = 1;
+        }
+        ++ctrlitr;
+    }
+}
+
+//****************************************************************************
+static void taa_ui_reset(
     taa_ui* ui,
     int vieww,
     int viewh,
-    const taa_keyboard_state* kb,
-    const taa_mouse_state* mouse,
-    const taa_window_event* winevents,
-    int numevents)
+    taa_ui_id rootid)
 {
     taa_ui_stack* s = ui->stack;
+    taa_ui_memoarena* arena;
     ui->viewwidth = vieww;
     ui->viewheight = viewh;
     ui->stackdepth = 0;
+    ui->maxstackdepth = 0;
+    ui->stackoverflow = 0;
     ui->ctrlcursor = ui->ctrlcapacity - 1;
     ui->textoffset = 0;
+    ui->numlists = 0;
+    ui->memodepth = 0;
+    ++ui->frame;
+    arena = ui->memoarenas + (ui->frame & 1);
+    arena->nummemos = 0;
+    arena->numcmds = 0;
+    arena->numctrls = 0;
+    arena->textsize = 0;
+    if(ui->intern.isfull)
+    {
+        // flush interned text once it runs out of room. the previous frame
+        // is no longer referenced at this point
+        taa_ui_textintern* intern = &ui->intern;
+        memset(intern->entries, 0, intern->capacity*sizeof(*intern->entries));
+        intern->count = 0;
+        intern->textsize = 0;
+        intern->isfull = 0;
+    }
     s->control = -1;
     s->layoutcmd = -1;
+    s->list = NULL;
+    s->id = rootid;
+    s->idscope = 0;
+    memset(s->ordinals, 0, sizeof(s->ordinals));
+    taa_uilayout_begin(&ui->layout);
+    taa_uiidle_begin(&ui->idle);
+}
+
+//****************************************************************************
+void taa_ui_begin(
+    taa_ui* ui,
+    int vieww,
+    int viewh,
+    const taa_keyboard_state* kb,
+    const taa_mouse_state* mouse,
+    const taa_window_event* winevents,
+    int numevents)
+{
+    // the root id is the hash of no bytes
+    taa_ui_reset(ui, vieww, viewh, taa_UIHASH_BASIS);
     taa_uiinput_begin(
         &ui->prevstate,
         &ui->nextstate,
@@ -203,7 +1198,21 @@ void taa_ui_begin(
         mouse,
         winevents,
         numevents);
-    taa_uilayout_begin(&ui->layout);
+}
+
+//****************************************************************************
+void taa_ui_begin_child(
+    taa_ui* child,
+    const taa_ui* parent,
+    taa_ui_id rootid)
+{
+    taa_ui_reset(child, parent->viewwidth, parent->viewheight, rootid);
+    // the child reacts to the same input as the parent. focus found in the
+    // child is passed back to the parent when the child is spliced
+    child->prevstate = parent->prevstate;
+    child->nextstate = parent->nextstate;
+    child->nextstate.focusindex = -1;
+    child->nextstate.isdragging = 0;
 }
 
 //****************************************************************************
@@ -218,15 +1227,16 @@ taa_ui_handle taa_ui_button(
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     const taa_ui_style* style = ui->stylesheet + styleid;
     uint32_t txtlen = strlen(txt);
+    taa_ui_id id;
     int32_t control;
     int32_t layoutcmd;
+    id = taa_ui_calc_id(ui, taa_UI_BUTTON, txt, txtlen);
     if(taa_uiinput_try_focus(
         &ui->prevstate,
         &ui->nextstate,
         p->control,
         ui->ctrlcursor,
-        taa_UI_BUTTON,
-        styleid))
+        id))
     {
         flags |= taa_uiinput_button(&ui->prevstate);
     }
@@ -239,11 +1249,13 @@ taa_ui_handle taa_ui_button(
         taa_UI_BUTTON,
         styleid,
         flags,
+        id,
         txt,
         txtlen,
-        txtlen);
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
+        txtlen,
+        1);
+    layoutcmd = taa_ui_push_layout(
+        ui,
         taa_UILAYOUT_ABS,
         style->halign,
         style->valign,
@@ -254,7 +1266,7 @@ taa_ui_handle taa_ui_button(
         0,
         0,
         rect);
-    taa_uilayout_pop(&ui->layout, layoutcmd, -1);
+    taa_ui_pop_layout(ui, layoutcmd, -1);
     if(flags_out != NULL)
     {
         *flags_out = flags;
@@ -262,6 +1274,62 @@ taa_ui_handle taa_ui_button(
     return layoutcmd;
 }
 
+//****************************************************************************
+int taa_ui_calc_grid_cell(
+    int numcols,
+    int cellw,
+    int cellh,
+    int spacing,
+    int originx,
+    int originy,
+    int x,
+    int y)
+{
+    int pitchx = cellw + spacing;
+    int pitchy = cellh + spacing;
+    int dx = x - originx;
+    int dy = y - originy;
+    int result = -1;
+    if(numcols > 0 && pitchx > 0 && pitchy > 0 && dx >= 0 && dy >= 0)
+    {
+        int col = dx / pitchx;
+        int row = dy / pitchy;
+        // points in the spacing between cells do not hit a cell
+        if(col < numcols && dx-col*pitchx < cellw && dy-row*pitchy < cellh)
+        {
+            result = row * numcols + col;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+void taa_ui_calc_grid_range(
+    int numcols,
+    int cellh,
+    int spacing,
+    int originy,
+    int y,
+    int h,
+    int* begin_out,
+    int* end_out)
+{
+    int pitchy = cellh + spacing;
+    int top = y - originy;
+    int bottom = top + h;
+    int begin = 0;
+    int end = 0;
+    if(numcols > 0 && pitchy > 0 && h > 0 && bottom > 0)
+    {
+        // the range covers every row the span touches, rounded out to
+        // whole rows of cells
+        begin = (top > 0) ? (top / pitchy) * numcols : 0;
+        end = ((bottom - 1) / pitchy + 1) * numcols;
+    }
+    *begin_out = begin;
+    *end_out = end;
+}
+
 //****************************************************************************
 void taa_ui_create(
     size_t stacksize,
@@ -273,41 +1341,67 @@ void taa_ui_create(
 {
     void* buf;
     taa_ui* ui;
-    taa_ui_stack* stack;
-    taa_ui_control* ctrl;
-    taa_uilayout_cmd* layout;
-    char* text;
+    taa_ui_state* states;
+    size_t numstates;
+    // the state table is a power of two, with room for at least twice the
+    // number of controls to keep probe sequences short
+    numstates = 64;
+    while(numstates < maxcontrols * 2)
+    {
+        numstates <<= 1;
+    }
     // calculate structure offsets
     buf = NULL;
     ui = (taa_ui*) buf;
     buf = ui + 1;
-    stack = (taa_ui_stack*) taa_ALIGN_PTR(buf, 8);
-    buf = stack + stacksize;
-    ctrl = (taa_ui_control*) taa_ALIGN_PTR(buf, 8);
-    buf = ctrl + maxcontrols;
-    layout = (taa_uilayout_cmd*) taa_ALIGN_PTR(buf, 8);
-    buf = layout + maxcontrols;
-    text = (char*) taa_ALIGN_PTR(buf, 8);
-    buf = text + maxtext;
+    states = (taa_ui_state*) taa_ALIGN_PTR(buf, 8);
+    buf = states + numstates;
     // allocate buffer and adjust pointers
     buf = malloc((size_t) buf);
     ui = (taa_ui*) (((ptrdiff_t) ui) + ((ptrdiff_t) buf));
-    stack = (taa_ui_stack*) (((ptrdiff_t) stack) + ((ptrdiff_t) buf));
-    ctrl = (taa_ui_control*) (((ptrdiff_t) ctrl) + ((ptrdiff_t) buf));
-    layout = (taa_uilayout_cmd*) (((ptrdiff_t) layout) + ((ptrdiff_t) buf));
-    text = (char*)  (((ptrdiff_t) text) + ((ptrdiff_t) buf));
+    states = (taa_ui_state*) (((ptrdiff_t) states) + ((ptrdiff_t) buf));
     // initialize structures
     memset(ui, 0, sizeof(*ui));
+    // the sizes passed in are committed up front. the regions reserve room
+    // to grow beyond them without moving
+    stacksize = (stacksize > 0) ? stacksize : 1;
+    taa_uiarena_create(
+        &ui->stackarena,
+        sizeof(*ui->stack),
+        stacksize * taa_UI_RESERVE_SCALE,
+        stacksize,
+        0);
+    taa_uiarena_create(
+        &ui->ctrlarena,
+        sizeof(*ui->ctrlbuffer),
+        maxcontrols * taa_UI_RESERVE_SCALE,
+        maxcontrols,
+        1);
+    taa_uiarena_create(
+        &ui->layoutarena,
+        sizeof(*ui->layout.cmds),
+        maxcontrols * taa_UI_RESERVE_SCALE,
+        maxcontrols,
+        0);
+    taa_uiarena_create(
+        &ui->textarena,
+        sizeof(*ui->textbuffer),
+        maxtext * taa_UI_RESERVE_SCALE,
+        maxtext,
+        0);
     ui->stylesheet = stylesheet;
-    ui->stack = stack;
-    ui->ctrlbuffer = ctrl;
-    ui->textbuffer = text;
+    ui->stack = (taa_ui_stack*) ui->stackarena.elems;
+    ui->ctrlbuffer = (taa_ui_control*) ui->ctrlarena.elems;
+    ui->textbuffer = (char*) ui->textarena.elems;
     ui->numstyles = numstyles;
-    ui->stackcapacity = stacksize;
-    ui->ctrlcapacity = maxcontrols;
-    ui->textcapacity = maxtext;
-    ui->layout.cmds = layout;
-    ui->layout.capacity = maxcontrols;
+    ui->stackcapacity = ui->stackarena.capacity;
+    ui->ctrlcapacity = ui->ctrlarena.capacity;
+    ui->textcapacity = ui->textarena.capacity;
+    ui->layout.cmds = (taa_uilayout_cmd*) ui->layoutarena.elems;
+    ui->layout.capacity = ui->layoutarena.numcommitted;
+    ui->states = states;
+    ui->statecapacity = numstates;
+    memset(states, 0, numstates * sizeof(*states));
     // set out parameter
     *ui_out = ui;
 }
@@ -316,6 +1410,27 @@ void taa_ui_create(
 void taa_ui_destroy(
     taa_ui* ui)
 {
+    taa_ui_memoarena* arenaitr = ui->memoarenas;
+    taa_ui_memoarena* arenaend = arenaitr + 2;
+    while(arenaitr != arenaend)
+    {
+        taa_uiarena_destroy(&arenaitr->memoregion);
+        taa_uiarena_destroy(&arenaitr->cmdregion);
+        taa_uiarena_destroy(&arenaitr->ctrlregion);
+        taa_uiarena_destroy(&arenaitr->textregion);
+        ++arenaitr;
+    }
+    taa_uiarena_destroy(&ui->stackarena);
+    taa_uiarena_destroy(&ui->ctrlarena);
+    taa_uiarena_destroy(&ui->layoutarena);
+    taa_uiarena_destroy(&ui->textarena);
+    taa_uilayout_destroy(&ui->layout);
+    free(ui->damage.controls);
+    free(ui->damage.texthashes);
+    free(ui->idle.controls);
+    free(ui->intern.entries);
+    free(ui->ids.entries);
+    taa_uipick_destroy(&ui->pick);
     free(ui);
 }
 
@@ -327,14 +1442,15 @@ const taa_ui_controllist* taa_ui_end(
     taa_ui_controllist* cl = &ui->ctrllist;
     size_t firstcontrol = ui->ctrlcursor + 1;
     size_t numcontrols = ui->ctrlcapacity - firstcontrol;
+    taa_ui_listref* listitr;
+    taa_ui_listref* listend;
+    taa_ui_state* st;
+    taa_ui_id focusid;
+    unsigned int decommitframes;
+    int isidle = 0;
     assert(ui->stackdepth == 0);
-    taa_uilayout_end(&ui->layout, ui->stylesheet,ui->ctrlbuffer,&screenrect);
-    taa_uiinput_end(
-        &ui->prevstate,
-        &ui->nextstate,
-        ui->ctrlbuffer,
-        firstcontrol,
-        numcontrols);
+    // the draw callback is given the list during layout, so the fields that
+    // do not depend on layout are set first
     cl->controls = ui->ctrlbuffer + firstcontrol;
     cl->numcontrols = numcontrols;
     cl->caret = ui->prevstate.caret;
@@ -342,6 +1458,157 @@ const taa_ui_controllist* taa_ui_end(
     cl->selectlength = ui->prevstate.selectlength;
     cl->viewwidth = ui->viewwidth;
     cl->viewheight = ui->viewheight;
+    if((ui->options & taa_UI_OPTION_IDLE) != 0)
+    {
+        // the stylesheet is owned by the caller, and may change between
+        // frames without changing the control stream
+        taa_uiidle_add(
+            &ui->idle,
+            ui->stylesheet,
+            ui->numstyles * sizeof(*ui->stylesheet));
+        isidle = taa_uiidle_end(
+            &ui->idle,
+            numcontrols,
+            ui->layout.size,
+            ui->viewwidth,
+            ui->viewheight,
+            &ui->prevstate,
+            &ui->nextstate);
+    }
+    if(isidle)
+    {
+        // nothing changed, so the layout and input results of the previous
+        // frame are still valid
+        taa_uiidle_restore(
+            &ui->idle,
+            ui->ctrlbuffer + firstcontrol,
+            numcontrols);
+    }
+    else
+    {
+        taa_uilayout_end(
+            &ui->layout,
+            ui->stylesheet,
+            ui->ctrlbuffer,
+            &screenrect);
+        // store the measured viewport of each virtualized list so the next
+        // frame can determine which rows are visible
+        listitr = ui->lists;
+        listend = listitr + ui->numlists;
+        while(listitr != listend)
+        {
+            const taa_uilayout_cmd* cmd;
+            cmd = ui->layout.cmds + listitr->layoutcmd;
+            listitr->list->viewh = cmd->contentrect.h;
+            ++listitr;
+        }
+        // remember the caret of the focused control, so it can be restored
+        // if focus leaves and later returns to it
+        focusid = ui->prevstate.focusid;
+        if(ui->nextstate.focusindex >= 0)
+        {
+            st = taa_ui_find_state(ui, focusid, 1);
+            if(st != NULL)
+            {
+                st->flags |= taa_UI_FLAG_FOCUS;
+                st->caret = ui->nextstate.caret;
+                st->selectstart = ui->nextstate.selectstart;
+                st->selectlength = ui->nextstate.selectlength;
+            }
+        }
+        // the controls have moved, so the point query index is out of date.
+        // an idle frame keeps the index of the previous frame
+        taa_uipick_reset(
+            &ui->pick,
+            ui->ctrlbuffer + firstcontrol,
+            numcontrols,
+            ui->viewwidth,
+            ui->viewheight);
+        taa_uiinput_end(
+            &ui->prevstate,
+            &ui->nextstate,
+            ui->ctrlbuffer,
+            firstcontrol,
+            numcontrols,
+            &ui->pick);
+        if(ui->nextstate.focusid != focusid)
+        {
+            st = taa_ui_find_state(ui, focusid, 0);
+            if(st != NULL)
+            {
+                st->flags &= ~taa_UI_FLAG_FOCUS;
+            }
+            st = taa_ui_find_state(ui, ui->nextstate.focusid, 0);
+            if(st != NULL)
+            {
+                ui->nextstate.caret = st->caret;
+                ui->nextstate.selectstart = st->selectstart;
+                ui->nextstate.selectlength = st->selectlength;
+            }
+        }
+        if((ui->options & taa_UI_OPTION_IDLE) != 0)
+        {
+            taa_uiidle_store(
+                &ui->idle,
+                ui->ctrlbuffer + firstcontrol,
+                numcontrols,
+                ui->layout.size,
+                ui->viewwidth,
+                ui->viewheight,
+                &ui->prevstate);
+        }
+    }
+    taa_ui_sweep_states(ui);
+    // record high water marks, and release memory the ui no longer needs
+    decommitframes = ui->decommitframes;
+    taa_uiarena_end_frame(&ui->ctrlarena, numcontrols, decommitframes);
+    taa_uiarena_end_frame(&ui->layoutarena, ui->layout.size, decommitframes);
+    taa_uiarena_end_frame(&ui->textarena, ui->textoffset, decommitframes);
+    taa_uiarena_end_frame(
+        &ui->stackarena,
+        ui->maxstackdepth + 1,
+        decommitframes);
+    ui->layout.capacity = ui->layoutarena.numcommitted;
+    if(ui->memoarenas[0].memos != NULL)
+    {
+        taa_ui_memoarena* arena = ui->memoarenas + (ui->frame & 1);
+        unsigned int n = decommitframes;
+        taa_uiarena_end_frame(&arena->memoregion, arena->nummemos, n);
+        taa_uiarena_end_frame(&arena->cmdregion, arena->numcmds, n);
+        taa_uiarena_end_frame(&arena->ctrlregion, arena->numctrls, n);
+        taa_uiarena_end_frame(&arena->textregion, arena->textsize, n);
+    }
+    if(isidle)
+    {
+        ui->damage.numrects = 0;
+    }
+    else if((ui->options & taa_UI_OPTION_DAMAGE) != 0 &&
+            taa_uidamage_reserve(
+                &ui->damage,
+                numcontrols,
+                ui->ctrlarena.numcommitted))
+    {
+        // the copy of the control list grows with the control region
+        taa_uidamage_end(
+            &ui->damage,
+            cl->controls,
+            numcontrols,
+            cl->viewwidth,
+            cl->viewheight,
+            cl->caret,
+            cl->selectstart,
+            cl->selectlength);
+    }
+    else
+    {
+        // without damage tracking, or without room for the copy of the
+        // control list, the entire view is damaged
+        ui->damage.rects[0] = screenrect;
+        ui->damage.numrects = 1;
+    }
+    cl->damagerects = ui->damage.rects;
+    cl->numdamagerects = ui->damage.numrects;
+    cl->isunchanged = isidle;
     return cl;
 }
 
@@ -352,6 +1619,68 @@ unsigned int taa_ui_generate_id(
     return ++ui->idcounter;
 }
 
+//****************************************************************************
+taa_ui_id taa_ui_get_id(
+    taa_ui* ui,
+    taa_ui_handle handle)
+{
+    taa_ui_id id = 0;
+    if(handle < ui->layout.size)
+    {
+        int control = ui->layout.cmds[handle].control0;
+        if(control >= 0)
+        {
+            id = ui->ctrlbuffer[control].id;
+        }
+    }
+    return id;
+}
+
+//****************************************************************************
+taa_ui_state* taa_ui_get_state(
+    taa_ui* ui,
+    taa_ui_id id)
+{
+    return (id != 0) ? taa_ui_find_state(ui, id, 1) : NULL;
+}
+
+//****************************************************************************
+void taa_ui_get_usage(
+    const taa_ui* ui,
+    taa_ui_usage* usage_out)
+{
+    const taa_uiarena* arenas[4];
+    taa_ui_regionusage* usages[4];
+    int i;
+    arenas[0] = &ui->ctrlarena;
+    arenas[1] = &ui->layoutarena;
+    arenas[2] = &ui->textarena;
+    arenas[3] = &ui->stackarena;
+    usages[0] = &usage_out->controls;
+    usages[1] = &usage_out->layout;
+    usages[2] = &usage_out->text;
+    usages[3] = &usage_out->stack;
+    for(i = 0; i < 4; ++i)
+    {
+        const taa_uiarena* arena = arenas[i];
+        taa_ui_regionusage* usage = usages[i];
+        usage->frameused = arena->frameused * arena->elemsize;
+        usage->peakused = arena->peakused * arena->elemsize;
+        usage->committed = arena->committedbytes;
+        usage->reserved = arena->reservedbytes;
+    }
+}
+
+//****************************************************************************
+taa_ui_id taa_ui_hash_id(
+    taa_ui* ui,
+    const void* key,
+    size_t keylen)
+{
+    taa_ui_id id = taa_uihash_add(ui->stack[ui->stackdepth].id, key, keylen);
+    return (id != 0) ? id : 1;
+}
+
 //****************************************************************************
 taa_ui_handle taa_ui_label(
     taa_ui* ui,
@@ -369,11 +1698,13 @@ taa_ui_handle taa_ui_label(
         taa_UI_LABEL,
         styleid,
         taa_UI_FLAG_DISABLED,
+        taa_ui_calc_id(ui, taa_UI_LABEL, NULL, 0),
         txt,
         txtlen,
-        txtlen);
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
+        txtlen,
+        1);
+    layoutcmd = taa_ui_push_layout(
+        ui,
         taa_UILAYOUT_ABS,
         style->halign,
         style->valign,
@@ -384,10 +1715,147 @@ taa_ui_handle taa_ui_label(
         0,
         0,
         rect);
-    taa_uilayout_pop(&ui->layout, layoutcmd, -1);
+    taa_ui_pop_layout(ui, layoutcmd, -1);
     return layoutcmd;
 }
 
+//****************************************************************************
+int taa_ui_memo_begin(
+    taa_ui* ui,
+    unsigned int key,
+    uint32_t contenthash)
+{
+    int build = 1;
+    if(ui->memodepth < taa_UI_MAX_MEMO_DEPTH && taa_ui_alloc_memo(ui))
+    {
+        const taa_ui_stack* p = ui->stack + ui->stackdepth;
+        taa_ui_stack* scope = ui->stack + p->idscope;
+        taa_ui_memoscope* ms = ui->memostack + ui->memodepth;
+        taa_ui_state* st;
+        taa_ui_id id;
+        id = taa_uihash_add(p->id, "memo", 4);
+        id = taa_uihash_add(id, &key, sizeof(key));
+        id = (id != 0) ? id : 1;
+        ms->id = id;
+        ms->hash = contenthash;
+        ms->stackdepth = ui->stackdepth;
+        ms->numlists = ui->numlists;
+        ms->cmdbegin = (int) ui->layout.size;
+        ms->ctrlbegin = ui->ctrlcursor;
+        ms->replayed = 0;
+        memcpy(ms->ordinals, scope->ordinals, sizeof(ms->ordinals));
+        st = taa_ui_find_state(ui, id, 1);
+        if(st != NULL && st->memoframe == ui->frame - 1)
+        {
+            const taa_ui_memoarena* prev;
+            taa_ui_memoarena* arena;
+            prev = ui->memoarenas + ((ui->frame - 1) & 1);
+            arena = ui->memoarenas + (ui->frame & 1);
+            if(((size_t) st->memoindex) < prev->nummemos)
+            {
+                const taa_ui_memo* memo = prev->memos + st->memoindex;
+                if(taa_ui_test_memo(ui, prev, memo, ms))
+                {
+                    // carry the subtree forward into the arena of the
+                    // current frame, then copy it into the frame
+                    int index = taa_ui_store_memo(
+                        arena,
+                        memo,
+                        prev->cmds + memo->cmdoffset,
+                        prev->ctrls + memo->ctrloffset);
+                    if(index >= 0)
+                    {
+                        memo = arena->memos + index;
+                        taa_ui_replay_memo(ui, arena, memo);
+                        memcpy(
+                            scope->ordinals,
+                            memo->endordinals,
+                            sizeof(scope->ordinals));
+                        st->memoframe = ui->frame;
+                        st->memoindex = index;
+                        ms->replayed = 1;
+                        build = 0;
+                    }
+                }
+            }
+        }
+    }
+    ++ui->memodepth;
+    return build;
+}
+
+//****************************************************************************
+void taa_ui_memo_end(
+    taa_ui* ui)
+{
+    assert(ui->memodepth > 0);
+    --ui->memodepth;
+    if(ui->memodepth<taa_UI_MAX_MEMO_DEPTH && ui->memoarenas[0].memos!=NULL)
+    {
+        const taa_ui_stack* p = ui->stack + ui->stackdepth;
+        const taa_ui_memoscope* ms = ui->memostack + ui->memodepth;
+        assert(ms->stackdepth == ui->stackdepth);
+        if(!ms->replayed)
+        {
+            taa_ui_memo memo;
+            int focusindex = ui->nextstate.focusindex;
+            int replayable;
+            memo.id = ms->id;
+            memo.hash = ms->hash;
+            memo.pathid = p->id;
+            memcpy(memo.beginordinals, ms->ordinals, sizeof(ms->ordinals));
+            memcpy(
+                memo.endordinals,
+                ui->stack[p->idscope].ordinals,
+                sizeof(memo.endordinals));
+            memo.cmdbase = ms->cmdbegin;
+            memo.ctrlbase = ui->ctrlcursor + 1;
+            memo.numcmds = ((int) ui->layout.size) - ms->cmdbegin;
+            memo.numctrls = ms->ctrlbegin - ui->ctrlcursor;
+            // the subtree may only be replayed if it is self contained: it
+            // did not overflow, does not hold focus, does not register
+            // lists, and does not target containers outside of it
+            replayable =
+                ms->stackdepth == ui->stackdepth &&
+                ms->numlists == ui->numlists &&
+                ui->ctrlcursor >= 0 &&
+                ui->layout.size < ui->layoutarena.capacity &&
+                (focusindex < memo.ctrlbase || focusindex > ms->ctrlbegin);
+            if(replayable)
+            {
+                const taa_uilayout_cmd* cmditr;
+                const taa_uilayout_cmd* cmdend;
+                cmditr = ui->layout.cmds + memo.cmdbase;
+                cmdend = cmditr + memo.numcmds;
+                while(cmditr != cmdend)
+                {
+                    if(cmditr->targetcmd>=0 && cmditr->targetcmd<memo.cmdbase)
+                    {
+                        replayable = 0;
+                        break;
+                    }
+                    ++cmditr;
+                }
+            }
+            if(replayable)
+            {
+                taa_ui_state* st;
+                int index = taa_ui_store_memo(
+                    ui->memoarenas + (ui->frame & 1),
+                    &memo,
+                    ui->layout.cmds + memo.cmdbase,
+                    ui->ctrlbuffer + memo.ctrlbase);
+                st = taa_ui_find_state(ui, ms->id, 0);
+                if(st != NULL && index >= 0)
+                {
+                    st->memoframe = ui->frame;
+                    st->memoindex = index;
+                }
+            }
+        }
+    }
+}
+
 //****************************************************************************
 taa_ui_handle taa_ui_numberbox(
     taa_ui* ui,
@@ -402,6 +1870,7 @@ taa_ui_handle taa_ui_numberbox(
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     const taa_ui_style* style = ui->stylesheet + styleid;
     char txt[12];
+    taa_ui_id id;
     int val;
     int control;
     int layoutcmd;
@@ -435,13 +1904,14 @@ taa_ui_handle taa_ui_numberbox(
         i /= 8; 
     }
     assert(txtsize <= sizeof(txt));
+    id = taa_ui_calc_id(ui, taa_UI_NUMBERBOX, NULL, 0);
+    taa_ui_keep_state(ui, id);
     if(taa_uiinput_try_focus(
         &ui->prevstate,
         &ui->nextstate,
         p->control,
         ui->ctrlcursor,
-        taa_UI_NUMBERBOX,
-        styleid))
+        id))
     {
         flags |= taa_uiinput_text(
             &ui->prevstate,
@@ -475,14 +1945,58 @@ taa_ui_handle taa_ui_numberbox(
     }
     control = taa_ui_push_text_control(
         ui,
-        taa_UI_NUMBERBOX,
+        taa_UI_NUMBERBOX,
+        styleid,
+        flags,
+        id,
+        txt,
+        txtlen,
+        txtsize - 1,
+        0);
+    layoutcmd = taa_ui_push_layout(
+        ui,
+        taa_UILAYOUT_ABS,
+        style->halign,
+        style->valign,
+        0,
+        p->layoutcmd,
+        -1,
+        control,
+        0,
+        0,
+        rect);
+    taa_ui_pop_layout(ui, layoutcmd, -1);
+    if(flags_out != NULL)
+    {
+        *flags_out = flags;
+    }
+    return layoutcmd;
+}
+
+//****************************************************************************
+taa_ui_handle taa_ui_paragraph(
+    taa_ui* ui,
+    taa_ui_styleid styleid,
+    const taa_ui_rect* rect,
+    const char* txt)
+{
+    const taa_ui_stack* p = ui->stack + ui->stackdepth;
+    const taa_ui_style* style = ui->stylesheet + styleid;
+    uint32_t txtlen = strlen(txt);
+    int32_t control;
+    int32_t layoutcmd;
+    control = taa_ui_push_text_control(
+        ui,
+        taa_UI_PARAGRAPH,
         styleid,
-        flags,
+        taa_UI_FLAG_DISABLED,
+        taa_ui_calc_id(ui, taa_UI_PARAGRAPH, NULL, 0),
         txt,
         txtlen,
-        txtsize - 1);
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
+        txtlen,
+        1);
+    layoutcmd = taa_ui_push_layout(
+        ui,
         taa_UILAYOUT_ABS,
         style->halign,
         style->valign,
@@ -493,12 +2007,24 @@ taa_ui_handle taa_ui_numberbox(
         0,
         0,
         rect);
-    taa_uilayout_pop(&ui->layout, layoutcmd, -1);
-    if(flags_out != NULL)
+    taa_ui_pop_layout(ui, layoutcmd, -1);
+    // the heights of all commands are sized after the widths from now on
+    ui->layout.iswrapping = 1;
+    return layoutcmd;
+}
+
+//****************************************************************************
+int taa_ui_pick(
+    taa_ui* ui,
+    int x,
+    int y)
+{
+    int result = -1;
+    if(ui->pick.controls != NULL)
     {
-        *flags_out = flags;
+        result = taa_uipick_find(&ui->pick, x, y);
     }
-    return layoutcmd;
+    return result;
 }
 
 //****************************************************************************
@@ -506,8 +2032,11 @@ void taa_ui_pop_cols(
     taa_ui* ui)
 {
     const taa_ui_stack* s = ui->stack + ui->stackdepth;
-    taa_uilayout_pop(&ui->layout, s->layoutcmd, -1);
-    taa_ui_pop_stack(ui);
+    if(!taa_ui_pop_overflow(ui))
+    {
+        taa_ui_pop_layout(ui, s->layoutcmd, -1);
+        taa_ui_pop_stack(ui);
+    }
 }
 
 //****************************************************************************
@@ -524,102 +2053,177 @@ taa_ui_handle taa_ui_pop_container(
     int focusindex;
     int beginindex;
     int endindex;
-    int layoutcmd;
+    int layoutcmd = -1;
     int scrollx;
     int scrolly;
-    beginindex = ui->ctrlcursor;
-    endindex = s->control;
-    endctrl = ui->ctrlbuffer + endindex;
-    flags = endctrl->flags;
-    focusindex = ui->prevstate.focusindex;
-    layoutcmd = s->layoutcmd;
-    scrollx = s->scrollx;
-    scrolly = s->scrolly;
-    // do not attempt to grab focus for the container until the pop
-    // container function. this allows children the opportunity to grab it
-    // first
-    if(taa_uiinput_try_focus(
-            &ui->prevstate,
-            &ui->nextstate,
-            p->control,
-            ui->ctrlcursor,
-            taa_UI_CONTAINER_BEGIN,
-            endctrl->styleid))
+    if(!taa_ui_pop_overflow(ui))
     {
-        // treat the focus input as if the container is a button
-        flags |= taa_uiinput_button(&ui->prevstate);
-    }
-    else if(focusindex >= beginindex && focusindex <= endindex)
-    {
-        // if one of the children is focused, propogate the flag up
-        flags |= taa_UI_FLAG_FOCUS;
-        if(ui->nextstate.focusparent[1] == endindex)
-        {
-            // if this is the immediate parent of the focused control, fix the
-            // focus parent range and attempt to scroll the focused child
-            // into view if it is clipped
-            taa_ui_rect* cliprect = &ui->prevstate.focuscontrol.cliprect;
-            taa_ui_rect* focusrect = &ui->prevstate.focuscontrol.rect;
-            int clipx;
-            int childx;
-            int clipy;
-            int childy;
-            ui->nextstate.focusparent[0] = beginindex;
-            clipx = cliprect->x;
-            childx = focusrect->x;
-            if(clipx > childx)
-            {
-                scrollx -= clipx - childx;
-            }
-            clipx += cliprect->w;
-            childx += focusrect->w;
-            if(clipx < childx)
-            {
-                scrollx += childx - clipx;
-            }
-            clipy = cliprect->y;
-            childy = focusrect->y;
-            if(clipy > childy)
+        beginindex = ui->ctrlcursor;
+        endindex = s->control;
+        endctrl = ui->ctrlbuffer + endindex;
+        flags = endctrl->flags;
+        focusindex = ui->nextstate.focusindex;
+        layoutcmd = s->layoutcmd;
+        scrollx = s->scrollx;
+        scrolly = s->scrolly;
+        // do not attempt to grab focus for the container until the pop
+        // container function. this allows children the opportunity to grab it
+        // first
+        if(taa_uiinput_try_focus(
+                &ui->prevstate,
+                &ui->nextstate,
+                p->control,
+                ui->ctrlcursor,
+                endctrl->id))
+        {
+            // treat the focus input as if the container is a button
+            flags |= taa_uiinput_button(&ui->prevstate);
+        }
+        else if(focusindex >= beginindex && focusindex <= endindex)
+        {
+            // if one of the children is focused, propogate the flag up
+            flags |= taa_UI_FLAG_FOCUS;
+            if(ui->nextstate.focusparent[1] == endindex)
             {
-                scrolly -= clipy - childy;
+                // if this is the immediate parent of the focused control,
+                // fix the focus parent range and attempt to scroll the
+                // focused child into view if it is clipped
+                taa_ui_rect* cliprect = &ui->prevstate.focuscontrol.cliprect;
+                taa_ui_rect* focusrect = &ui->prevstate.focuscontrol.rect;
+                int clipx;
+                int childx;
+                int clipy;
+                int childy;
+                ui->nextstate.focusparent[0] = beginindex;
+                clipx = cliprect->x;
+                childx = focusrect->x;
+                if(clipx > childx)
+                {
+                    scrollx -= clipx - childx;
+                }
+                clipx += cliprect->w;
+                childx += focusrect->w;
+                if(clipx < childx)
+                {
+                    scrollx += childx - clipx;
+                }
+                clipy = cliprect->y;
+                childy = focusrect->y;
+                if(clipy > childy)
+                {
+                    scrolly -= clipy - childy;
+                }
+                clipy += cliprect->h;
+                childy += focusrect->h;
+                if(clipy < childy)
+                {
+                    scrolly += childy - clipy;
+                }
+                // keep layout consistent
+                ui->layout.cmds[layoutcmd].scrollx = scrollx;
+                ui->layout.cmds[layoutcmd].scrolly = scrolly;
             }
-            clipy += cliprect->h;
-            childy += focusrect->h;
-            if(clipy < childy)
+        }
+        // make sure the flags are consistent for both begin and end control
+        endctrl->flags = flags;
+        // because the control buffer is filled in reverse order, the
+        // container begin control is added in the pop container function
+        beginindex = taa_ui_push_id_control(
+            ui,
+            taa_UI_CONTAINER_BEGIN,
+            endctrl->styleid,
+            flags,
+            endctrl->id,
+            endctrl->data.id.id);
+        if(beginindex >= 0)
+        {
+            // the span is relative, so it stays valid when the controls
+            // are copied by memoization or splicing
+            ui->ctrlbuffer[beginindex].data.id.numdescendants =
+                endindex - beginindex - 1;
+        }
+        taa_ui_pop_layout(
+            ui,
+            layoutcmd,
+            beginindex);
+        taa_ui_pop_stack(ui);
+        if(endctrl->data.id.id != ((unsigned int) -1))
+        {
+            // containers with an explicit id keep their scroll position
+            taa_ui_state* st = taa_ui_find_state(ui, endctrl->id, 1);
+            if(st != NULL)
             {
-                scrolly += childy - clipy;
+                st->scrollx = scrollx;
+                st->scrolly = scrolly;
             }
-            // keep layout consistent
-            ui->layout.cmds[layoutcmd].scrollx = scrollx;
-            ui->layout.cmds[layoutcmd].scrolly = scrolly;
+        }
+        if(scrollx_out != NULL)
+        {
+            *scrollx_out = scrollx;
+        }
+        if(scrolly_out != NULL)
+        {
+            *scrolly_out = scrolly;
+        }
+        if(flags_out != NULL)
+        {
+            *flags_out = flags;
         }
     }
-    // make sure the flags are consistent for both begin and end control
-    endctrl->flags = flags;
-    // because the control buffer is filled in reverse order, the container
-    // begin control is added in the pop container function
-    beginindex = taa_ui_push_id_control(
-        ui,
-        taa_UI_CONTAINER_BEGIN,
-        endctrl->styleid,
-        flags,
-        endctrl->data.id.id);
-    taa_uilayout_pop(
-        &ui->layout,
-        layoutcmd,
-        beginindex);
-    taa_ui_pop_stack(ui);
-    if(scrollx_out != NULL)
+    return layoutcmd;
+}
+
+//****************************************************************************
+void taa_ui_pop_grid(
+    taa_ui* ui)
+{
+    const taa_ui_stack* s = ui->stack + ui->stackdepth;
+    if(!taa_ui_pop_overflow(ui))
     {
-        *scrollx_out = scrollx;
+        taa_ui_pop_layout(ui, s->layoutcmd, -1);
+        taa_ui_pop_stack(ui);
     }
-    if(scrolly_out != NULL)
+}
+
+//****************************************************************************
+void taa_ui_pop_id(
+    taa_ui* ui)
+{
+    if(!taa_ui_pop_overflow(ui))
     {
-        *scrolly_out = scrolly;
+        taa_ui_pop_stack(ui);
     }
-    if(flags_out != NULL)
+}
+
+//****************************************************************************
+taa_ui_handle taa_ui_pop_list(
+    taa_ui* ui,
+    int* scrolly_out,
+    unsigned int* flags_out)
+{
+    taa_ui_list* list;
+    int layoutcmd = -1;
+    if(!taa_ui_pop_overflow(ui))
     {
-        *flags_out = flags;
+        taa_ui_pop_rows(ui);
+        list = ui->stack[ui->stackdepth].list;
+        layoutcmd = taa_ui_pop_container(ui, NULL, scrolly_out, flags_out);
+    }
+    if(layoutcmd >= 0)
+    {
+        // the rows that were not added still contribute to the scroll range
+        ui->layout.cmds[layoutcmd].virtualh = list->contenth;
+        if(ui->numlists < taa_UI_MAX_LISTS)
+        {
+            taa_ui_listref* ref = ui->lists + ui->numlists;
+            ref->list = list;
+            ref->layoutcmd = layoutcmd;
+            ++ui->numlists;
+        }
+        else
+        {
+            taa_LOG_WARN("exceeded ui list limit");
+        }
     }
     return layoutcmd;
 }
@@ -629,8 +2233,11 @@ void taa_ui_pop_rect(
     taa_ui* ui)
 {
     const taa_ui_stack* s = ui->stack + ui->stackdepth;
-    taa_uilayout_pop(&ui->layout, s->layoutcmd, -1);
-    taa_ui_pop_stack(ui);
+    if(!taa_ui_pop_overflow(ui))
+    {
+        taa_ui_pop_layout(ui, s->layoutcmd, -1);
+        taa_ui_pop_stack(ui);
+    }
 }
 
 //****************************************************************************
@@ -638,8 +2245,11 @@ void taa_ui_pop_rows(
     taa_ui* ui)
 {
     const taa_ui_stack* s = ui->stack + ui->stackdepth;
-    taa_uilayout_pop(&ui->layout, s->layoutcmd, -1);
-    taa_ui_pop_stack(ui);
+    if(!taa_ui_pop_overflow(ui))
+    {
+        taa_ui_pop_layout(ui, s->layoutcmd, -1);
+        taa_ui_pop_stack(ui);
+    }
 }
 
 //****************************************************************************
@@ -651,19 +2261,22 @@ void taa_ui_push_cols(
 {
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     int layoutcmd;
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
-        taa_UILAYOUT_COLS,
-        taa_UI_HALIGN_LEFT,
-        valign,
-        spacing,
-        p->layoutcmd,
-        -1,
-        -1,
-        0,
-        0,
-        rect);
-    taa_ui_push_stack(ui, p->control, layoutcmd, 0, 0);
+    if(taa_ui_reserve_stack(ui, 1, 0))
+    {
+        layoutcmd = taa_ui_push_layout(
+            ui,
+            taa_UILAYOUT_COLS,
+            taa_UI_HALIGN_LEFT,
+            valign,
+            spacing,
+            p->layoutcmd,
+            -1,
+            -1,
+            0,
+            0,
+            rect);
+        taa_ui_push_stack(ui, p->control, layoutcmd, 0, 0, p->id, 0);
+    }
 }
 
 //****************************************************************************
@@ -678,29 +2291,164 @@ void taa_ui_push_container(
 {
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     const taa_ui_style* style = ui->stylesheet + styleid;
+    taa_ui_id ctrlid;
     int endcontrol;
     int layoutcmd;
-    // because the control buffer is filled in reverse order, the container
-    // end control is added in the push container function
-    endcontrol = taa_ui_push_id_control(
-        ui,
-        taa_UI_CONTAINER_END,
-        styleid,
-        flags,
-        id);
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
-        taa_UILAYOUT_ABS,
-        style->halign,
-        style->valign,
-        0,
-        p->layoutcmd,
-        -1,
-        endcontrol,
-        scrollx,
-        scrolly,
-        rect);
-    taa_ui_push_stack(ui, endcontrol, layoutcmd, scrollx, scrolly);
+    if(taa_ui_reserve_stack(ui, 1, 2))
+    {
+        // containers with an explicit id use it as their key
+        if(id != ((unsigned int) -1))
+        {
+            ctrlid = taa_ui_calc_id(
+                ui,
+                taa_UI_CONTAINER_BEGIN,
+                &id,
+                sizeof(id));
+        }
+        else
+        {
+            ctrlid = taa_ui_calc_id(ui, taa_UI_CONTAINER_BEGIN, NULL, 0);
+        }
+        // because the control buffer is filled in reverse order, the
+        // container end control is added in the push container function
+        endcontrol = taa_ui_push_id_control(
+            ui,
+            taa_UI_CONTAINER_END,
+            styleid,
+            flags,
+            ctrlid,
+            id);
+        layoutcmd = taa_ui_push_layout(
+            ui,
+            taa_UILAYOUT_ABS,
+            style->halign,
+            style->valign,
+            0,
+            p->layoutcmd,
+            -1,
+            endcontrol,
+            scrollx,
+            scrolly,
+            rect);
+        taa_ui_push_stack(ui,endcontrol,layoutcmd,scrollx,scrolly,ctrlid,1);
+    }
+}
+
+//****************************************************************************
+void taa_ui_push_grid(
+    taa_ui* ui,
+    taa_ui_halign halign,
+    taa_ui_valign valign,
+    int spacing,
+    int cellw,
+    int cellh,
+    int numcols,
+    const taa_ui_rect* rect)
+{
+    const taa_ui_stack* p = ui->stack + ui->stackdepth;
+    int layoutcmd;
+    if(taa_ui_reserve_stack(ui, 1, 0))
+    {
+        layoutcmd = taa_ui_push_layout(
+            ui,
+            taa_UILAYOUT_GRID,
+            halign,
+            valign,
+            spacing,
+            p->layoutcmd,
+            -1,
+            -1,
+            0,
+            0,
+            rect);
+        if(layoutcmd >= 0)
+        {
+            taa_uilayout_cmd* cmd = ui->layout.cmds + layoutcmd;
+            cmd->cellw = cellw;
+            cmd->cellh = cellh;
+            // a grid has at least one column, so its rows can be counted
+            cmd->numcols = (numcols > 0) ? numcols : 1;
+            // the grid fields may be packed into 16 bits
+            assert(cmd->cellw == cellw && cmd->cellh == cellh);
+            assert(cmd->numcols == ((numcols > 0) ? numcols : 1));
+        }
+        taa_ui_push_stack(ui, p->control, layoutcmd, 0, 0, p->id, 0);
+    }
+}
+
+//****************************************************************************
+void taa_ui_push_id(
+    taa_ui* ui,
+    unsigned int key)
+{
+    const taa_ui_stack* p = ui->stack + ui->stackdepth;
+    if(taa_ui_reserve_stack(ui, 1, 0))
+    {
+        taa_ui_push_stack(
+            ui,
+            p->control,
+            p->layoutcmd,
+            0,
+            0,
+            taa_ui_hash_id(ui, &key, sizeof(key)),
+            1);
+    }
+}
+
+//****************************************************************************
+void taa_ui_push_list(
+    taa_ui* ui,
+    taa_ui_styleid styleid,
+    unsigned int flags,
+    const taa_ui_rect* rect,
+    int scrolly,
+    unsigned int id,
+    taa_ui_list* list,
+    int* begin_out,
+    int* end_out)
+{
+    taa_ui_rect rowsrect = { 0, 0, taa_UI_WIDTH_FILL, taa_UI_HEIGHT_FILL };
+    taa_ui_stack* s;
+    int viewh;
+    int begin;
+    int end;
+    int y;
+    // until the list has been laid out once, assume it may fill the view
+    viewh = list->viewh;
+    if(viewh <= 0)
+    {
+        viewh = (rect->h > 0) ? rect->h : ui->viewheight;
+    }
+    taa_ui_calc_list_range(list, scrolly, viewh, &begin, &end, &y);
+    // the list container, rows and spacer are pushed together, so room for
+    // all of them is reserved up front
+    if(taa_ui_reserve_stack(ui, 3, 2))
+    {
+        taa_ui_push_container(ui, styleid, flags, rect, 0, scrolly, id);
+        s = ui->stack + ui->stackdepth;
+        s->list = list;
+        taa_ui_push_rows(ui, taa_UI_HALIGN_LEFT, list->spacing, &rowsrect);
+        if(y > 0)
+        {
+            // offset the visible rows by the height of the rows that were
+            // skipped, using an empty layout rect as a spacer
+            taa_ui_rect spacerrect = { 0, 0, 0, 0 };
+            spacerrect.h = y - list->spacing;
+            taa_ui_push_rect(
+                ui,
+                taa_UI_HALIGN_LEFT,
+                taa_UI_VALIGN_TOP,
+                &spacerrect);
+            taa_ui_pop_rect(ui);
+        }
+    }
+    else
+    {
+        begin = 0;
+        end = 0;
+    }
+    *begin_out = begin;
+    *end_out = end;
 }
 
 //****************************************************************************
@@ -712,19 +2460,22 @@ void taa_ui_push_rect(
 {
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     int layoutcmd;
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
-        taa_UILAYOUT_ABS,
-        halign,
-        valign,
-        0,
-        p->layoutcmd,
-        -1,
-        -1,
-        0,
-        0,
-        rect);
-    taa_ui_push_stack(ui, p->control, layoutcmd, 0, 0);
+    if(taa_ui_reserve_stack(ui, 1, 0))
+    {
+        layoutcmd = taa_ui_push_layout(
+            ui,
+            taa_UILAYOUT_ABS,
+            halign,
+            valign,
+            0,
+            p->layoutcmd,
+            -1,
+            -1,
+            0,
+            0,
+            rect);
+        taa_ui_push_stack(ui, p->control, layoutcmd, 0, 0, p->id, 0);
+    }
 }
 
 //****************************************************************************
@@ -736,19 +2487,206 @@ void taa_ui_push_rows(
 {
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     int layoutcmd;
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
-        taa_UILAYOUT_ROWS,
-        halign,
-        taa_UI_VALIGN_TOP,
-        spacing,
-        p->layoutcmd,
-        -1,
-        -1,
-        0,
-        0,
-        rect);
-    taa_ui_push_stack(ui, p->control, layoutcmd, 0, 0);
+    if(taa_ui_reserve_stack(ui, 1, 0))
+    {
+        layoutcmd = taa_ui_push_layout(
+            ui,
+            taa_UILAYOUT_ROWS,
+            halign,
+            taa_UI_VALIGN_TOP,
+            spacing,
+            p->layoutcmd,
+            -1,
+            -1,
+            0,
+            0,
+            rect);
+        taa_ui_push_stack(ui, p->control, layoutcmd, 0, 0, p->id, 0);
+    }
+}
+
+//****************************************************************************
+void taa_ui_set_decommit_frames(
+    taa_ui* ui,
+    unsigned int numframes)
+{
+    ui->decommitframes = numframes;
+}
+
+//****************************************************************************
+void taa_ui_set_draw_callback(
+    taa_ui* ui,
+    taa_ui_drawfunc func,
+    void* userdata)
+{
+    ui->layout.drawfunc = func;
+    ui->layout.drawdata = userdata;
+    ui->layout.drawctrls = &ui->ctrllist;
+}
+
+//****************************************************************************
+void taa_ui_set_layout_dispatch(
+    taa_ui* ui,
+    taa_ui_dispatchfunc func,
+    void* userdata,
+    unsigned int threshold)
+{
+    ui->layout.dispatchfunc = func;
+    ui->layout.dispatchdata = userdata;
+    ui->layout.dispatchthreshold = threshold;
+}
+
+//****************************************************************************
+void taa_ui_set_options(
+    taa_ui* ui,
+    unsigned int options)
+{
+    if((options & taa_UI_OPTION_DAMAGE) != 0 && ui->damage.controls == NULL)
+    {
+        taa_uidamage_state* damage = &ui->damage;
+        size_t capacity = ui->ctrlarena.numcommitted;
+        damage->controls = (taa_ui_control*)
+            malloc(capacity * sizeof(*damage->controls));
+        damage->texthashes = (uint32_t*)
+            malloc(capacity * sizeof(*damage->texthashes));
+        damage->capacity = capacity;
+    }
+    if((options & taa_UI_OPTION_INTERN_TEXT) != 0 &&
+       ui->intern.entries == NULL)
+    {
+        taa_ui_textintern* intern = &ui->intern;
+        size_t capacity = ui->statecapacity;
+        size_t textcapacity = ui->textarena.numcommitted;
+        void* buf;
+        buf = malloc(capacity * sizeof(*intern->entries) + textcapacity);
+        intern->entries = (taa_ui_internentry*) buf;
+        intern->capacity = capacity;
+        intern->text = (char*) (intern->entries + capacity);
+        intern->count = 0;
+        intern->textsize = 0;
+        intern->textcapacity = textcapacity;
+        intern->isfull = 0;
+        memset(buf, 0, capacity * sizeof(*intern->entries));
+    }
+    if((options & taa_UI_OPTION_DAMAGE) == 0)
+    {
+        // the previous frame must be compared in full when re-enabled
+        ui->damage.isvalid = 0;
+    }
+    if((options & taa_UI_OPTION_IDLE) == 0)
+    {
+        ui->idle.isvalid = 0;
+    }
+    ui->layout.isculling = (options & taa_UI_OPTION_CULL) != 0;
+    ui->options = options;
+}
+
+//****************************************************************************
+void taa_ui_splice(
+    taa_ui* ui,
+    taa_ui* child)
+{
+    const taa_ui_stack* p = ui->stack + ui->stackdepth;
+    int firstcontrol = child->ctrlcursor + 1;
+    int numctrls = ((int) child->ctrlcapacity) - firstcontrol;
+    int numcmds = (int) child->layout.size;
+    size_t textsize = child->textoffset;
+    assert(child->stackdepth == 0);
+    if(taa_ui_reserve_controls(ui, numctrls) &&
+       taa_ui_reserve_layout(ui, numcmds) &&
+       taa_uiarena_ensure(&ui->textarena, ui->textoffset + textsize) &&
+       ui->numlists + child->numlists <= taa_UI_MAX_LISTS)
+    {
+        const char* srctxt = child->textbuffer;
+        char* dsttxt = ui->textbuffer + ui->textoffset;
+        int cmdbase = (int) ui->layout.size;
+        int ctrlbegin = ui->ctrlcursor + 1 - numctrls;
+        int ctrldelta = ctrlbegin - firstcontrol;
+        taa_uiinput_state* next = &ui->nextstate;
+        const taa_uiinput_state* childnext = &child->nextstate;
+        taa_ui_control* ctrlitr;
+        taa_ui_control* ctrlend;
+        size_t i;
+        memcpy(dsttxt, srctxt, textsize);
+        ui->textoffset += textsize;
+        ui->layout.iswrapping |= child->layout.iswrapping;
+        taa_ui_append_stream(
+            ui,
+            child->layout.cmds,
+            numcmds,
+            0,
+            child->ctrlbuffer + firstcontrol,
+            numctrls,
+            firstcontrol);
+        // text in the text buffer of the child moves with the controls.
+        // static and interned text is left where it is
+        ctrlitr = ui->ctrlbuffer + ctrlbegin;
+        ctrlend = ctrlitr + numctrls;
+        while(ctrlitr != ctrlend)
+        {
+            if(ctrlitr->data.type == taa_UI_DATA_TEXT)
+            {
+                const char* txt = ctrlitr->data.text.text;
+                if(txt >= srctxt && txt <= srctxt + textsize)
+                {
+                    ctrlitr->data.text.text = dsttxt + (txt - srctxt);
+                }
+            }
+            if((ui->options & taa_UI_OPTION_IDLE) != 0)
+            {
+                taa_uiidle_add_control(&ui->idle, ctrlitr);
+            }
+            ++ctrlitr;
+        }
+        if((ui->options & taa_UI_OPTION_IDLE) != 0)
+        {
+            for(i = cmdbase; i < ui->layout.size; ++i)
+            {
+                taa_uiidle_add_cmd(&ui->idle, ui->layout.cmds + i);
+            }
+        }
+        for(i = 0; i < child->numlists; ++i)
+        {
+            taa_ui_listref* ref = ui->lists + ui->numlists;
+            ref->list = child->lists[i].list;
+            ref->layoutcmd = child->lists[i].layoutcmd + cmdbase;
+            ++ui->numlists;
+        }
+        if(childnext->focusindex >= 0)
+        {
+            // the focused control was found in the child. focus parents
+            // at the root of the child belong to the current parent
+            next->focusindex = childnext->focusindex + ctrldelta;
+            next->focusid = childnext->focusid;
+            for(i = 0; i < 2; ++i)
+            {
+                next->focusparent[i] = (childnext->focusparent[i] >= 0) ?
+                    childnext->focusparent[i] + ctrldelta :
+                    p->control;
+            }
+            next->caret = childnext->caret;
+            next->selectstart = childnext->selectstart;
+            next->selectlength = childnext->selectlength;
+        }
+        if(childnext->isdragging)
+        {
+            next->isdragging = 1;
+            next->dragx = childnext->dragx;
+            next->dragy = childnext->dragy;
+        }
+        // events consumed by the child must not be processed again
+        for(i = 0; i < ui->prevstate.numevents; ++i)
+        {
+            ui->prevstate.events[i].isconsumed |=
+                child->prevstate.events[i].isconsumed;
+        }
+    }
+    else
+    {
+        taa_LOG_WARN("exceeded ui limits splicing child");
+    }
+    // the child does not call taa_ui_end, so its states are swept here
+    taa_ui_sweep_states(child);
 }
 
 //****************************************************************************
@@ -763,16 +2701,18 @@ taa_ui_handle taa_ui_textbox(
 {
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     const taa_ui_style* style = ui->stylesheet + styleid;
+    taa_ui_id id;
     int control;
     int layoutcmd;
     size_t txtlen;
+    id = taa_ui_calc_id(ui, taa_UI_TEXTBOX, NULL, 0);
+    taa_ui_keep_state(ui, id);
     if(taa_uiinput_try_focus(
         &ui->prevstate,
         &ui->nextstate,
         p->control,
         ui->ctrlcursor,
-        taa_UI_TEXTBOX,
-        styleid))
+        id))
     {
         flags |= taa_uiinput_text(
             &ui->prevstate,
@@ -793,11 +2733,13 @@ taa_ui_handle taa_ui_textbox(
         taa_UI_TEXTBOX,
         styleid,
         flags,
+        id,
         txt,
         txtlen,
-        txtsize - 1);
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
+        txtsize - 1,
+        0);
+    layoutcmd = taa_ui_push_layout(
+        ui,
         taa_UILAYOUT_ABS,
         style->halign,
         style->valign,
@@ -808,7 +2750,7 @@ taa_ui_handle taa_ui_textbox(
         0,
         0,
         rect);
-    taa_uilayout_pop(&ui->layout, layoutcmd, -1);
+    taa_ui_pop_layout(ui, layoutcmd, -1);
     if(flags_out != NULL)
     {
         *flags_out = flags;
@@ -829,8 +2771,10 @@ taa_ui_handle taa_ui_vscrollbar(
 {
     const taa_ui_stack* p = ui->stack + ui->stackdepth;
     const taa_ui_style* style = ui->stylesheet + panestyleid;
+    taa_ui_id id;
     int control;
     int layoutcmd;
+    id = taa_ui_calc_id(ui, taa_UI_VSCROLLBAR, NULL, 0);
     flags &= taa_UI_FLAG_DISABLED;
     if((flags & taa_UI_FLAG_DISABLED) == 0)
     {
@@ -839,8 +2783,7 @@ taa_ui_handle taa_ui_vscrollbar(
             &ui->nextstate,
             p->control,
             ui->ctrlcursor,
-            taa_UI_VSCROLLBAR,
-            panestyleid))
+            id))
         {
             flags |= taa_uiinput_vscroll(&ui->prevstate,&ui->nextstate,value);
         }
@@ -851,10 +2794,11 @@ taa_ui_handle taa_ui_vscrollbar(
         panestyleid,
         sliderstyleid,
         flags,
+        id,
         0, // range has to be auto calculated later, when layout is known
         *value);
-    layoutcmd = taa_uilayout_push(
-        &ui->layout,
+    layoutcmd = taa_ui_push_layout(
+        ui,
         taa_UILAYOUT_ABS,
         style->halign,
         style->valign,
@@ -865,7 +2809,7 @@ taa_ui_handle taa_ui_vscrollbar(
         0,
         0,
         rect);
-    taa_uilayout_pop(&ui->layout, layoutcmd, -1);
+    taa_ui_pop_layout(ui, layoutcmd, -1);
     if(flags_out != NULL)
     {
         *flags_out = flags;
@@ -0,0 +1,348 @@
+/**
+ * @brief     ui reserve/commit memory region implementation
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#ifndef taa_UIARENA_H_
+#define taa_UIARENA_H_
+
+#include <taa/ui.h>
+#include <assert.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//****************************************************************************
+// enums
+
+enum
+{
+    /// minimum number of bytes committed at a time, to limit system calls
+    taa_UIARENA_COMMIT_MIN = 64 * 1024
+};
+
+//****************************************************************************
+// typedefs
+
+typedef struct taa_uiarena_s taa_uiarena;
+
+//****************************************************************************
+// structs
+
+/**
+ * @details a contiguous array of elements backed by a reserved range of
+ * address space. Pages are committed on demand, so the array grows without
+ * moving. Forward regions are committed from the first element up. Reverse
+ * regions are committed from the last element down, for arrays that are
+ * filled from the end, such as the control buffer.
+ */
+struct taa_uiarena_s
+{
+    void* elems;
+    unsigned char* reservation;
+    size_t reservedbytes;
+    size_t committedbytes;
+    size_t mincommittedbytes;
+    size_t elemsize;
+    size_t capacity;
+    size_t numcommitted;
+    int isreverse;
+    // high water marks in elements, and the highest usage seen during the
+    // current run of frames that used little of the committed memory
+    size_t frameused;
+    size_t peakused;
+    size_t lowpeak;
+    unsigned int lowframes;
+};
+
+//****************************************************************************
+// functions
+
+//****************************************************************************
+static size_t taa_uiarena_pagesize(void)
+{
+    static size_t pagesize;
+    if(pagesize == 0)
+    {
+#ifdef _WIN32
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        pagesize = si.dwPageSize;
+#else
+        pagesize = (size_t) sysconf(_SC_PAGESIZE);
+#endif
+    }
+    return pagesize;
+}
+
+//****************************************************************************
+static void* taa_uiarena_os_reserve(
+    size_t size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* p = mmap(
+        NULL,
+        size,
+        PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+        -1,
+        0);
+    return (p != MAP_FAILED) ? p : NULL;
+#endif
+}
+
+//****************************************************************************
+static int taa_uiarena_os_commit(
+    void* p,
+    size_t size)
+{
+#ifdef _WIN32
+    return VirtualAlloc(p, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+    return mprotect(p, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+//****************************************************************************
+static void taa_uiarena_os_decommit(
+    void* p,
+    size_t size)
+{
+#ifdef _WIN32
+    VirtualFree(p, size, MEM_DECOMMIT);
+#else
+    // mapping fresh inaccessible pages over the range returns the physical
+    // memory to the system while keeping the address range reserved
+    mmap(
+        p,
+        size,
+        PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED,
+        -1,
+        0);
+#endif
+}
+
+//****************************************************************************
+static void taa_uiarena_os_release(
+    void* p,
+    size_t size)
+{
+#ifdef _WIN32
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, size);
+#endif
+}
+
+//****************************************************************************
+static size_t taa_uiarena_round(
+    size_t size)
+{
+    size_t pagesize = taa_uiarena_pagesize();
+    return (size + pagesize - 1) & ~(pagesize - 1);
+}
+
+//****************************************************************************
+static void taa_uiarena_set_committed(
+    taa_uiarena* arena,
+    size_t bytes)
+{
+    size_t n;
+    arena->committedbytes = bytes;
+    // reverse regions are laid out so the last element ends at the end of
+    // the reservation, so in both directions the number of accessible
+    // elements is the number that fit in the committed bytes
+    n = bytes / arena->elemsize;
+    arena->numcommitted = (n < arena->capacity) ? n : arena->capacity;
+}
+
+//****************************************************************************
+static int taa_uiarena_commit(
+    taa_uiarena* arena,
+    size_t count)
+{
+    size_t needed;
+    size_t target;
+    // if the request exceeds the region, commit everything that is left so
+    // callers that truncate may use the rest of the region
+    needed = (count < arena->capacity) ? count : arena->capacity;
+    needed = taa_uiarena_round(needed * arena->elemsize);
+    if(needed > arena->committedbytes)
+    {
+        // grow geometrically to keep the number of system calls low
+        target = arena->committedbytes * 2;
+        target = (target > taa_UIARENA_COMMIT_MIN) ?
+            target :
+            taa_UIARENA_COMMIT_MIN;
+        target = (target > needed) ? target : needed;
+        target = taa_uiarena_round(target);
+        if(target > arena->reservedbytes)
+        {
+            target = arena->reservedbytes;
+        }
+        if(arena->isreverse)
+        {
+            unsigned char* end = arena->reservation + arena->reservedbytes;
+            if(taa_uiarena_os_commit(
+                end - target,
+                target - arena->committedbytes))
+            {
+                taa_uiarena_set_committed(arena, target);
+            }
+        }
+        else
+        {
+            if(taa_uiarena_os_commit(
+                arena->reservation + arena->committedbytes,
+                target - arena->committedbytes))
+            {
+                taa_uiarena_set_committed(arena, target);
+            }
+        }
+    }
+    return count <= arena->numcommitted;
+}
+
+//****************************************************************************
+/**
+ * @brief ensures the first count elements of a forward region, or the last
+ *        count elements of a reverse region, are accessible
+ * @return nonzero if the elements are accessible
+ */
+static int taa_uiarena_ensure(
+    taa_uiarena* arena,
+    size_t count)
+{
+    return count <= arena->numcommitted || taa_uiarena_commit(arena, count);
+}
+
+//****************************************************************************
+static void taa_uiarena_create(
+    taa_uiarena* arena,
+    size_t elemsize,
+    size_t capacity,
+    size_t initial,
+    int isreverse)
+{
+    size_t reservedbytes = taa_uiarena_round(capacity * elemsize);
+    void* reservation = taa_uiarena_os_reserve(reservedbytes);
+    if(reservation == NULL && initial < capacity)
+    {
+        // if the address space is not available, fall back to a fixed
+        // region of the initial size
+        capacity = initial;
+        reservedbytes = taa_uiarena_round(capacity * elemsize);
+        reservation = taa_uiarena_os_reserve(reservedbytes);
+    }
+    if(reservation == NULL)
+    {
+        capacity = 0;
+        reservedbytes = 0;
+    }
+    arena->reservation = (unsigned char*) reservation;
+    arena->reservedbytes = reservedbytes;
+    arena->committedbytes = 0;
+    arena->elemsize = elemsize;
+    arena->capacity = capacity;
+    arena->numcommitted = 0;
+    arena->isreverse = isreverse;
+    arena->elems = arena->reservation;
+    if(isreverse)
+    {
+        arena->elems = arena->reservation+reservedbytes-capacity*elemsize;
+    }
+    arena->frameused = 0;
+    arena->peakused = 0;
+    arena->lowpeak = 0;
+    arena->lowframes = 0;
+    if(initial > 0)
+    {
+        taa_uiarena_commit(arena, initial);
+    }
+    arena->mincommittedbytes = arena->committedbytes;
+}
+
+//****************************************************************************
+static void taa_uiarena_destroy(
+    taa_uiarena* arena)
+{
+    if(arena->reservation != NULL)
+    {
+        taa_uiarena_os_release(arena->reservation, arena->reservedbytes);
+    }
+    arena->reservation = NULL;
+    arena->elems = NULL;
+    arena->capacity = 0;
+    arena->numcommitted = 0;
+    arena->committedbytes = 0;
+}
+
+//****************************************************************************
+/**
+ * @brief records the usage of the region for the frame
+ * @details if decommitframes is nonzero and the frame used less than a
+ * quarter of the committed elements for that many consecutive frames, the
+ * region is decommitted down to twice the highest usage of those frames.
+ * The region never shrinks below its initial commit.
+ */
+static void taa_uiarena_end_frame(
+    taa_uiarena* arena,
+    size_t used,
+    unsigned int decommitframes)
+{
+    arena->frameused = used;
+    if(used > arena->peakused)
+    {
+        arena->peakused = used;
+    }
+    if(decommitframes > 0 && used*4 < arena->numcommitted)
+    {
+        if(used > arena->lowpeak)
+        {
+            arena->lowpeak = used;
+        }
+        ++arena->lowframes;
+        if(arena->lowframes >= decommitframes)
+        {
+            size_t target;
+            target = taa_uiarena_round(arena->lowpeak*2*arena->elemsize);
+            if(target < arena->mincommittedbytes)
+            {
+                target = arena->mincommittedbytes;
+            }
+            if(target < arena->committedbytes)
+            {
+                size_t size = arena->committedbytes - target;
+                if(arena->isreverse)
+                {
+                    unsigned char* end;
+                    end = arena->reservation + arena->reservedbytes;
+                    taa_uiarena_os_decommit(end-arena->committedbytes, size);
+                }
+                else
+                {
+                    taa_uiarena_os_decommit(arena->reservation+target, size);
+                }
+                taa_uiarena_set_committed(arena, target);
+            }
+            arena->lowpeak = 0;
+            arena->lowframes = 0;
+        }
+    }
+    else
+    {
+        arena->lowpeak = 0;
+        arena->lowframes = 0;
+    }
+}
+
+#endif // taa_UIARENA_H_
@@ -0,0 +1,311 @@
+/**
+ * @brief     ui damage rectangle implementation
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#ifndef taa_UIDAMAGE_H_
+#define taa_UIDAMAGE_H_
+
+#include "uihash.h"
+#include <taa/ui.h>
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct taa_uidamage_state_s taa_uidamage_state;
+
+struct taa_uidamage_state_s
+{
+    // copy of the control list from the previous frame. text pointers are
+    // not valid across frames, so a hash of the text is kept instead
+    taa_ui_control* controls;
+    uint32_t* texthashes;
+    size_t capacity;
+    size_t numcontrols;
+    int isvalid;
+    int viewwidth;
+    int viewheight;
+    int caret;
+    int selectstart;
+    int selectlength;
+    // merged damage rectangles calculated for the current frame
+    size_t numrects;
+    taa_ui_rect rects[taa_UI_MAX_DAMAGE_RECTS];
+};
+
+//****************************************************************************
+static int taa_uidamage_area(
+    const taa_ui_rect* r)
+{
+    return r->w * r->h;
+}
+
+//****************************************************************************
+static void taa_uidamage_union(
+    const taa_ui_rect* a,
+    const taa_ui_rect* b,
+    taa_ui_rect* r_out)
+{
+    int xl = (a->x < b->x) ? a->x : b->x;
+    int xr = (a->x+a->w > b->x+b->w) ? a->x+a->w : b->x+b->w;
+    int yt = (a->y < b->y) ? a->y : b->y;
+    int yb = (a->y+a->h > b->y+b->h) ? a->y+a->h : b->y+b->h;
+    r_out->x = xl;
+    r_out->y = yt;
+    r_out->w = xr - xl;
+    r_out->h = yb - yt;
+}
+
+//****************************************************************************
+static void taa_uidamage_add(
+    taa_uidamage_state* state,
+    const taa_ui_rect* rect)
+{
+    taa_ui_rect r = *rect;
+    size_t i = 0;
+    int isempty = r.w <= 0 || r.h <= 0;
+    while(!isempty && i < state->numrects)
+    {
+        taa_ui_rect* e = state->rects + i;
+        // rects that overlap or touch are merged, and the merged rect is
+        // tested against the whole list again, since it may have grown to
+        // overlap rects that were already tested
+        if(r.x <= e->x+e->w && e->x <= r.x+r.w &&
+           r.y <= e->y+e->h && e->y <= r.y+r.h)
+        {
+            taa_uidamage_union(&r, e, &r);
+            --state->numrects;
+            *e = state->rects[state->numrects];
+            i = 0;
+        }
+        else if(i == state->numrects-1 &&
+                state->numrects == taa_UI_MAX_DAMAGE_RECTS)
+        {
+            // the list is full, so merge with the rect that adds the least
+            // amount of undamaged area, then test the result again
+            size_t best = 0;
+            int bestcost = INT_MAX;
+            size_t j;
+            for(j = 0; j < state->numrects; ++j)
+            {
+                taa_ui_rect u;
+                int cost;
+                taa_uidamage_union(&r, state->rects + j, &u);
+                cost = taa_uidamage_area(&u);
+                cost -= taa_uidamage_area(state->rects + j);
+                if(cost < bestcost)
+                {
+                    best = j;
+                    bestcost = cost;
+                }
+            }
+            taa_uidamage_union(&r, state->rects + best, &r);
+            --state->numrects;
+            state->rects[best] = state->rects[state->numrects];
+            i = 0;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    if(!isempty)
+    {
+        assert(state->numrects < taa_UI_MAX_DAMAGE_RECTS);
+        state->rects[state->numrects] = r;
+        ++state->numrects;
+    }
+}
+
+//****************************************************************************
+static uint32_t taa_uidamage_hash_text(
+    const taa_ui_control* ctrl)
+{
+    uint32_t h = taa_UIHASH_BASIS;
+    if(ctrl->data.type == taa_UI_DATA_TEXT)
+    {
+        h = taa_uihash_add(
+            h,
+            ctrl->data.text.text,
+            ctrl->data.text.textlength);
+    }
+    return h;
+}
+
+//****************************************************************************
+static int taa_uidamage_equal_rects(
+    const taa_ui_rect* a,
+    const taa_ui_rect* b)
+{
+    return a->x == b->x && a->y == b->y && a->w == b->w && a->h == b->h;
+}
+
+//****************************************************************************
+static int taa_uidamage_equal(
+    const taa_ui_control* a,
+    uint32_t ahash,
+    const taa_ui_control* b,
+    uint32_t bhash)
+{
+    int result =
+        a->type == b->type &&
+        a->styleid == b->styleid &&
+        a->flags == b->flags &&
+        a->id == b->id &&
+        a->data.type == b->data.type &&
+        taa_uidamage_equal_rects(&a->rect, &b->rect) &&
+        taa_uidamage_equal_rects(&a->cliprect, &b->cliprect);
+    if(result)
+    {
+        switch(a->data.type)
+        {
+        case taa_UI_DATA_ID:
+            result = a->data.id.id == b->data.id.id;
+            break;
+        case taa_UI_DATA_SCROLL:
+            result =
+                a->data.scroll.range == b->data.scroll.range &&
+                a->data.scroll.value == b->data.scroll.value &&
+                a->data.scroll.sliderstyleid==b->data.scroll.sliderstyleid &&
+                taa_uidamage_equal_rects(
+                    &a->data.scroll.sliderrect,
+                    &b->data.scroll.sliderrect) &&
+                taa_uidamage_equal_rects(
+                    &a->data.scroll.sliderpane,
+                    &b->data.scroll.sliderpane);
+            break;
+        case taa_UI_DATA_TEXT:
+            result =
+                a->data.text.textlength == b->data.text.textlength &&
+                ahash == bhash;
+            break;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief grows the copy of the control list to hold a frame
+ * @details if the copy cannot be grown, the old copy is kept but no longer
+ * describes the previous frame, so the next frame that fits damages the
+ * whole view
+ * @param capacity number of controls to grow the copy to if it is too small
+ * @return nonzero if the copy can hold numcontrols controls
+ */
+static int taa_uidamage_reserve(
+    taa_uidamage_state* state,
+    size_t numcontrols,
+    size_t capacity)
+{
+    int result = 1;
+    if(numcontrols > state->capacity)
+    {
+        taa_ui_control* controls = (taa_ui_control*) realloc(
+            state->controls,
+            capacity * sizeof(*state->controls));
+        uint32_t* texthashes;
+        if(controls != NULL)
+        {
+            state->controls = controls;
+        }
+        texthashes = (uint32_t*) realloc(
+            state->texthashes,
+            capacity * sizeof(*state->texthashes));
+        if(texthashes != NULL)
+        {
+            state->texthashes = texthashes;
+        }
+        if(controls != NULL && texthashes != NULL)
+        {
+            state->capacity = capacity;
+        }
+        else
+        {
+            state->isvalid = 0;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+static void taa_uidamage_end(
+    taa_uidamage_state* state,
+    const taa_ui_control* controls,
+    size_t numcontrols,
+    int viewwidth,
+    int viewheight,
+    int caret,
+    int selectstart,
+    int selectlength)
+{
+    taa_ui_control* prevctrls = state->controls;
+    uint32_t* prevhashes = state->texthashes;
+    int caretchanged;
+    size_t i;
+    assert(numcontrols <= state->capacity);
+    state->numrects = 0;
+    caretchanged =
+        caret != state->caret ||
+        selectstart != state->selectstart ||
+        selectlength != state->selectlength;
+    if(state->isvalid &&
+       viewwidth == state->viewwidth &&
+       viewheight == state->viewheight)
+    {
+        // controls are compared by their position in the list. when a
+        // control differs, both the old and new area are damaged
+        for(i = 0; i < numcontrols; ++i)
+        {
+            const taa_ui_control* ctrl = controls + i;
+            uint32_t hash = taa_uidamage_hash_text(ctrl);
+            if(i < state->numcontrols)
+            {
+                if(!taa_uidamage_equal(ctrl,hash,prevctrls+i,prevhashes[i]))
+                {
+                    taa_uidamage_add(state, &prevctrls[i].cliprect);
+                    taa_uidamage_add(state, &ctrl->cliprect);
+                }
+                else if(caretchanged &&
+                        (ctrl->flags & taa_UI_FLAG_FOCUS) != 0 &&
+                        ctrl->data.type == taa_UI_DATA_TEXT)
+                {
+                    taa_uidamage_add(state, &ctrl->cliprect);
+                }
+            }
+            else
+            {
+                taa_uidamage_add(state, &ctrl->cliprect);
+            }
+            prevctrls[i] = *ctrl;
+            prevhashes[i] = hash;
+        }
+        // controls that no longer exist damage the area they covered
+        for(i = numcontrols; i < state->numcontrols; ++i)
+        {
+            taa_uidamage_add(state, &prevctrls[i].cliprect);
+        }
+    }
+    else
+    {
+        taa_ui_rect viewrect = { 0, 0, viewwidth, viewheight };
+        taa_uidamage_add(state, &viewrect);
+        for(i = 0; i < numcontrols; ++i)
+        {
+            prevhashes[i] = taa_uidamage_hash_text(controls + i);
+        }
+        memcpy(prevctrls, controls, numcontrols * sizeof(*controls));
+    }
+    state->numcontrols = numcontrols;
+    state->isvalid = 1;
+    state->viewwidth = viewwidth;
+    state->viewheight = viewheight;
+    state->caret = caret;
+    state->selectstart = selectstart;
+    state->selectlength = selectlength;
+}
+
+#endif // taa_UIDAMAGE_H_
@@ -153,6 +153,7 @@ void taa_ui_add_drawlist_text(
     uint32_t color,
     const char* txt,
     size_t txtlen,
+    int txtw,
     int x,
     int y,
     int w,
@@ -198,12 +199,15 @@ void taa_ui_add_drawlist_text(
     {
         int txth = font->charheight;
         int n;
+        if(txtw < 0 && halign != taa_UI_HALIGN_LEFT)
+        {
+            txtw = taa_ui_calc_font_width(font, txt, txtlen);
+        }
         // horizontally align
         switch(halign)
         {
         case taa_UI_HALIGN_CENTER:
             {
-                int txtw = taa_ui_calc_font_width(font, txt, txtlen);
                 if(txtw <= w)
                 {
                     int xoff = ((w - txtw) >> 1);
@@ -220,7 +224,6 @@ void taa_ui_add_drawlist_text(
             break;
         case taa_UI_HALIGN_RIGHT:
             {
-                int txtw = taa_ui_calc_font_width(font, txt, txtlen);
                 if(w > txtw)
                 {
                     int xoff = w - txtw;
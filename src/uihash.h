@@ -0,0 +1,48 @@
+/**
+ * @brief     ui FNV-1a hash implementation
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#ifndef taa_UIHASH_H_
+#define taa_UIHASH_H_
+
+#include <taa/ui.h>
+#include <stddef.h>
+
+//****************************************************************************
+// enums
+
+enum
+{
+    /// FNV-1a offset basis, the hash of no bytes
+    taa_UIHASH_BASIS = 2166136261u,
+    /// FNV-1a prime
+    taa_UIHASH_PRIME = 16777619u
+};
+
+//****************************************************************************
+// functions
+
+//****************************************************************************
+/**
+ * @brief continues a hash with a sequence of bytes
+ * @param h the hash so far, or taa_UIHASH_BASIS to begin a new hash
+ */
+static uint32_t taa_uihash_add(
+    uint32_t h,
+    const void* data,
+    size_t size)
+{
+    const unsigned char* d = (const unsigned char*) data;
+    const unsigned char* dend = d + size;
+    while(d != dend)
+    {
+        h ^= *d;
+        h *= taa_UIHASH_PRIME;
+        ++d;
+    }
+    return h;
+}
+
+#endif // taa_UIHASH_H_
@@ -0,0 +1,252 @@
+/**
+ * @brief     ui idle frame detection implementation
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#ifndef taa_UIIDLE_H_
+#define taa_UIIDLE_H_
+
+#include "uihash.h"
+#include "uiinput.h"
+#include "uilayout.h"
+#include <taa/ui.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct taa_uiidle_state_s taa_uiidle_state;
+
+struct taa_uiidle_state_s
+{
+    // hash of the control and layout stream submitted during the frame,
+    // and the hash of the stream submitted during the previous frame
+    uint32_t hash;
+    uint32_t prevhash;
+    int isvalid;
+    int viewwidth;
+    int viewheight;
+    int caret;
+    int selectstart;
+    int selectlength;
+    size_t numcmds;
+    // copy of the control list calculated by the last frame that ran
+    // layout. idle frames restore the layout results from it
+    taa_ui_control* controls;
+    size_t capacity;
+    size_t numcontrols;
+};
+
+//****************************************************************************
+static void taa_uiidle_add(
+    taa_uiidle_state* state,
+    const void* data,
+    size_t size)
+{
+    state->hash = taa_uihash_add(state->hash, data, size);
+}
+
+//****************************************************************************
+static void taa_uiidle_add_int(
+    taa_uiidle_state* state,
+    int value)
+{
+    taa_uiidle_add(state, &value, sizeof(value));
+}
+
+//****************************************************************************
+static void taa_uiidle_add_rect(
+    taa_uiidle_state* state,
+    const taa_ui_rect* rect)
+{
+    taa_uiidle_add_int(state, rect->x);
+    taa_uiidle_add_int(state, rect->y);
+    taa_uiidle_add_int(state, rect->w);
+    taa_uiidle_add_int(state, rect->h);
+}
+
+//****************************************************************************
+/**
+ * @brief adds a control to the hash of the frame once it has been filled
+ * @details only the fields set by the simulation are hashed. the rects are
+ * calculated by layout, and are covered by the hash of the layout stream.
+ */
+static void taa_uiidle_add_control(
+    taa_uiidle_state* state,
+    const taa_ui_control* ctrl)
+{
+    taa_uiidle_add_int(state, ctrl->type);
+    taa_uiidle_add_int(state, ctrl->styleid);
+    taa_uiidle_add_int(state, ctrl->flags);
+    taa_uiidle_add_int(state, ctrl->id);
+    taa_uiidle_add_int(state, ctrl->data.type);
+    switch(ctrl->data.type)
+    {
+    case taa_UI_DATA_ID:
+        taa_uiidle_add_int(state, ctrl->data.id.id);
+        break;
+    case taa_UI_DATA_SCROLL:
+        taa_uiidle_add_int(state, ctrl->data.scroll.sliderstyleid);
+        taa_uiidle_add_int(state, ctrl->data.scroll.range);
+        taa_uiidle_add_int(state, ctrl->data.scroll.value);
+        break;
+    case taa_UI_DATA_TEXT:
+        taa_uiidle_add_int(state, ctrl->data.text.textlength);
+        taa_uiidle_add_int(state, ctrl->data.text.textcapacity);
+        taa_uiidle_add(
+            state,
+            ctrl->data.text.text,
+            ctrl->data.text.textlength);
+        break;
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief adds a layout command to the hash of the frame once it is popped
+ */
+static void taa_uiidle_add_cmd(
+    taa_uiidle_state* state,
+    const taa_uilayout_cmd* cmd)
+{
+    taa_uiidle_add_int(state, cmd->mode);
+    taa_uiidle_add_int(state, cmd->halign);
+    taa_uiidle_add_int(state, cmd->valign);
+    taa_uiidle_add_rect(state, &cmd->rect);
+    taa_uiidle_add_int(state, cmd->spacing);
+    taa_uiidle_add_int(state, cmd->scrollx);
+    taa_uiidle_add_int(state, cmd->scrolly);
+    taa_uiidle_add_int(state, cmd->parentcmd);
+    taa_uiidle_add_int(state, cmd->targetcmd);
+    taa_uiidle_add_int(state, cmd->childbegin);
+    taa_uiidle_add_int(state, cmd->childend);
+    taa_uiidle_add_int(state, cmd->control0);
+    taa_uiidle_add_int(state, cmd->control1);
+    taa_uiidle_add_int(state, cmd->virtualh);
+    taa_uiidle_add_int(state, cmd->cellw);
+    taa_uiidle_add_int(state, cmd->cellh);
+    taa_uiidle_add_int(state, cmd->numcols);
+}
+
+//****************************************************************************
+static void taa_uiidle_begin(
+    taa_uiidle_state* state)
+{
+    state->hash = taa_UIHASH_BASIS;
+}
+
+//****************************************************************************
+/**
+ * @brief compares the frame against the previous frame
+ * @details the frame is idle if the submitted stream, the view size and the
+ * input are all unchanged. any events, including events that are waiting
+ * to be processed by the next frame, prevent the frame from being idle.
+ * @return nonzero if the frame is idle
+ */
+static int taa_uiidle_end(
+    taa_uiidle_state* state,
+    size_t numcontrols,
+    size_t numcmds,
+    int viewwidth,
+    int viewheight,
+    const taa_uiinput_state* prevstate,
+    const taa_uiinput_state* nextstate)
+{
+    int result =
+        state->isvalid &&
+        state->hash == state->prevhash &&
+        numcontrols == state->numcontrols &&
+        numcmds == state->numcmds &&
+        viewwidth == state->viewwidth &&
+        viewheight == state->viewheight &&
+        prevstate->numevents == 0 &&
+        nextstate->numevents == 0 &&
+        prevstate->caret == state->caret &&
+        prevstate->selectstart == state->selectstart &&
+        prevstate->selectlength == state->selectlength &&
+        !memcmp(&prevstate->kb, &nextstate->kb, sizeof(nextstate->kb)) &&
+        !memcmp(&prevstate->mouse,&nextstate->mouse,sizeof(nextstate->mouse));
+    state->prevhash = state->hash;
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief copies the layout results of the previous frame into the controls
+ */
+static void taa_uiidle_restore(
+    const taa_uiidle_state* state,
+    taa_ui_control* controls,
+    size_t numcontrols)
+{
+    const taa_ui_control* srcitr = state->controls;
+    taa_ui_control* dstitr = controls;
+    taa_ui_control* dstend = dstitr + numcontrols;
+    assert(numcontrols == state->numcontrols);
+    while(dstitr != dstend)
+    {
+        dstitr->rect = srcitr->rect;
+        dstitr->cliprect = srcitr->cliprect;
+        if(dstitr->data.type == taa_UI_DATA_SCROLL)
+        {
+            dstitr->data.scroll = srcitr->data.scroll;
+        }
+        else if(dstitr->data.type == taa_UI_DATA_TEXT)
+        {
+            // the measured width and the lines of paragraphs are set by
+            // layout. the lines are held by the wrap cache, which is only
+            // changed by frames that run layout
+            dstitr->data.text.textwidth = srcitr->data.text.textwidth;
+            dstitr->data.text.numlines = srcitr->data.text.numlines;
+            dstitr->data.text.lines = srcitr->data.text.lines;
+        }
+        ++srcitr;
+        ++dstitr;
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief records a frame that ran layout, so later frames may reuse it
+ */
+static void taa_uiidle_store(
+    taa_uiidle_state* state,
+    const taa_ui_control* controls,
+    size_t numcontrols,
+    size_t numcmds,
+    int viewwidth,
+    int viewheight,
+    const taa_uiinput_state* prevstate)
+{
+    state->isvalid = 1;
+    if(numcontrols > state->capacity)
+    {
+        taa_ui_control* ctrls = (taa_ui_control*) realloc(
+            state->controls,
+            numcontrols * sizeof(*state->controls));
+        if(ctrls != NULL)
+        {
+            state->controls = ctrls;
+            state->capacity = numcontrols;
+        }
+        else
+        {
+            // keep the old copy, and lay out every frame until there is
+            // room to store one
+            state->isvalid = 0;
+        }
+    }
+    if(state->isvalid)
+    {
+        memcpy(state->controls, controls, numcontrols * sizeof(*controls));
+    }
+    state->numcontrols = numcontrols;
+    state->numcmds = numcmds;
+    state->viewwidth = viewwidth;
+    state->viewheight = viewheight;
+    state->caret = prevstate->caret;
+    state->selectstart = prevstate->selectstart;
+    state->selectlength = prevstate->selectlength;
+}
+
+#endif // taa_UIIDLE_H_
@@ -7,6 +7,7 @@
 #ifndef taa_UIINPUT_H_
 #define taa_UIINPUT_H_
 
+#include "uipick.h"
 #include <taa/ui.h>
 #include <assert.h>
 #include <ctype.h>
@@ -38,6 +39,7 @@ struct taa_uiinput_state_s
     // input events for the frame
     size_t numevents;
     taa_uiinput_event events[16];
+    taa_ui_id focusid;
     int focusindex;
     int focusparent[2];
     int caret;
@@ -167,15 +169,17 @@ static void taa_uiinput_end(
     taa_uiinput_state* nextstate,
     taa_ui_control* controls,
     int firstcontrol,
-    size_t numcontrols)
+    size_t numcontrols,
+    taa_uipick_grid* pick)
 {
     taa_uiinput_event* evt;
     taa_uiinput_event* evtend;
     int focusindex;
     focusindex = nextstate->focusindex;
     // check if any unhandled keyboard navigation events are left over from
-    // this frame.
-    if(prevstate->focusindex >= 0)
+    // this frame. navigation starts from the index the focused control was
+    // found at during this frame.
+    if(focusindex >= 0)
     {
         const taa_ui_control* focusctrl = &prevstate->focuscontrol;
         taa_keyboard_keycode navkey = taa_KEY_UNKNOWN;
@@ -232,7 +236,7 @@ static void taa_uiinput_end(
         {
             // tab navigation. iterate backwards so tab order is same order
             // in which controls were added to the ui simulation
-            taa_ui_control* focusctrl = controls + prevstate->focusindex;
+            taa_ui_control* focusctrl = controls + nextstate->focusindex;
             taa_ui_control* ctrlitr = focusctrl - 1;
             taa_ui_control* ctrlend = controls + firstcontrol - 1;
             if(ctrlitr == ctrlend)
@@ -258,25 +262,29 @@ static void taa_uiinput_end(
         }
         else if(navkey != taa_KEY_UNKNOWN)
         {
-            taa_ui_control* focusctrl = controls + prevstate->focusindex;
+            taa_ui_control* focusctrl = controls + nextstate->focusindex;
             taa_ui_control* ctrlitr;
             taa_ui_control* ctrlend;
-            int depth;
-            if(prevstate->focusparent[0] >= 0)
+            if(nextstate->focusparent[0] >= 0)
             {
-                ctrlitr = controls + (prevstate->focusparent[0]+1);
-                ctrlend = controls + (prevstate->focusparent[1]);
+                ctrlitr = controls + (nextstate->focusparent[0]+1);
+                ctrlend = controls + (nextstate->focusparent[1]);
             }
             else
             {
                 ctrlitr = controls + firstcontrol;
                 ctrlend = ctrlitr + numcontrols;
             }
-            depth = 0;
+            // only the immediate children of the focus parent are
+            // candidates, so the subtrees of nested containers are skipped
+            // rather than scanned. focus moves at most one step per frame,
+            // and like the first taa_UIPICK_MAX_SCANS point queries, a
+            // single query is cheaper to scan than to index. the pick grid
+            // would not help either, as it only holds the clip rects of
+            // visible controls, and focus may move out of view
             while(ctrlitr != ctrlend)
             {
                 if(
-                    depth == 0 &&
                     (ctrlitr->flags & taa_UI_FLAG_DISABLED) == 0 &&
                     ctrlitr->type != taa_UI_CONTAINER_END &&
                     ctrlitr->type != taa_UI_LABEL)
@@ -333,16 +341,14 @@ static void taa_uiinput_end(
                 }
                 if(ctrlitr->type == taa_UI_CONTAINER_BEGIN)
                 {
-                    ++depth;
-                }
-                else if(ctrlitr->type == taa_UI_CONTAINER_END)
-                {
-                    --depth;
+                    // move to the end control of the container
+                    ctrlitr += ctrlitr->data.id.numdescendants + 1;
+                    assert(ctrlitr < ctrlend);
+                    assert(ctrlitr->type == taa_UI_CONTAINER_END);
                 }
                 ++ctrlitr;
             }
-            assert(depth == 0);
-            if(focusctrl != (controls + prevstate->focusindex))
+            if(focusctrl != (controls + nextstate->focusindex))
             {
                 focusindex = (int) (ptrdiff_t) (focusctrl - controls);
             }
@@ -361,31 +367,29 @@ static void taa_uiinput_end(
         assert(!evt->isconsumed);
         if(evt->winevent.type == taa_WINDOW_EVENT_MOUSE_BUTTON1_DOWN)
         {
-            taa_ui_control* ctrlitr = controls + (firstcontrol+numcontrols-1);
-            taa_ui_control* ctrlend = controls + firstcontrol - 1;
             int x = evt->winevent.mouse.cursorx;
             int y = evt->winevent.mouse.cursory;
+            int index;
             nextstate->focusindex = -1;
-            while(ctrlitr != ctrlend)
+            // a click is usually the only query of the frame, which is
+            // answered by a scan rather than by building the grid
+            index = taa_uipick_find(pick, x, y);
+            if(index >= 0)
             {
-                if(
-                    ctrlitr->type != taa_UI_CONTAINER_END &&
-                    ctrlitr->type != taa_UI_LABEL)
-                {
-                    if(taa_uiinput_testrect(x, y, &ctrlitr->cliprect))
-                    {
-                        focusindex = (int) (ptrdiff_t) (ctrlitr-controls);
-                        break;
-                    }
-                }
-                --ctrlitr;
+                focusindex = firstcontrol + index;
             }
             break;
         }
         ++evt;
     }
     nextstate->focusindex = focusindex;
-    if(focusindex != prevstate->focusindex)
+    nextstate->focusid = 0;
+    if(focusindex >= 0)
+    {
+        nextstate->focuscontrol = controls[focusindex];
+        nextstate->focusid = controls[focusindex].id;
+    }
+    if(nextstate->focusid != prevstate->focusid)
     {
         nextstate->focusparent[0] = -1;
         nextstate->focusparent[1] = -1;
@@ -393,10 +397,6 @@ static void taa_uiinput_end(
         nextstate->selectstart = 0;
         nextstate->selectlength = 0;
     }
-    if(focusindex >= 0)
-    {
-        nextstate->focuscontrol = controls[focusindex];
-    }
 }
 
 //****************************************************************************
@@ -654,24 +654,19 @@ static int taa_uiinput_try_focus(
     taa_uiinput_state* nextstate,
     int parent,
     int index,
-    taa_ui_type type,
-    taa_ui_styleid styleid)
+    taa_ui_id id)
 {
     int result = 0;
-    if(
-        prevstate->focusindex == index &&
-        prevstate->focuscontrol.type == type &&
-        prevstate->focuscontrol.styleid == styleid)
+    // focus is matched by id rather than control index, so that controls
+    // added or removed before the focused control do not steal its focus.
+    // the id already incorporates the path of the parent containers.
+    if(id != 0 && prevstate->focusid == id)
     {
-        if( prevstate->focusparent[0]== -1 ||
-            prevstate->focusparent[0]==parent ||
-            prevstate->focusparent[1]==parent)
-        {
-            nextstate->focusparent[0] = parent;
-            nextstate->focusparent[1] = parent;
-            nextstate->focusindex = index;
-            result = 1;
-        }
+        nextstate->focusparent[0] = parent;
+        nextstate->focusparent[1] = parent;
+        nextstate->focusindex = index;
+        nextstate->focusid = id;
+        result = 1;
     }
     return result;
 }
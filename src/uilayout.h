@@ -7,9 +7,12 @@
 #ifndef taa_UILAYOUT_H_
 #define taa_UILAYOUT_H_
 
+#include "uiwrap.h"
 #include <taa/ui.h>
 #include <assert.h>
 #include <limits.h>
+#include <string.h>
+#include <stdlib.h>
 
 //****************************************************************************
 // enums
@@ -18,7 +21,8 @@ enum taa_uilayout_mode_e
 {
     taa_UILAYOUT_ABS,
     taa_UILAYOUT_COLS,
-    taa_UILAYOUT_ROWS
+    taa_UILAYOUT_ROWS,
+    taa_UILAYOUT_GRID
 };
 
 //****************************************************************************
@@ -27,19 +31,40 @@ enum taa_uilayout_mode_e
 typedef enum taa_uilayout_mode_e taa_uilayout_mode;
 
 typedef struct taa_uilayout_cmd_s taa_uilayout_cmd;
+typedef struct taa_uilayout_dispatch_s taa_uilayout_dispatch;
+typedef struct taa_uilayout_frame_s taa_uilayout_frame;
 typedef struct taa_uilayout_list_s taa_uilayout_list;
+typedef struct taa_uilayout_task_s taa_uilayout_task;
 
 //****************************************************************************
 // structs
 
+// a node of the layout tree. if taa_UI_PACK_LAYOUT_FIELDS is defined, the
+// enums are packed into bit fields, and the spacing, grid cell size and
+// number of grid columns are stored in 16 bits, which limits them to 32767.
+// the indices and the rects keep their full size
 struct taa_uilayout_cmd_s
 {
+#ifdef taa_UI_PACK_LAYOUT_FIELDS
+    unsigned int mode : 2;
+    unsigned int halign : 2;
+    unsigned int valign : 2;
+    int16_t spacing;
+    int16_t cellw;
+    int16_t cellh;
+    int16_t numcols;
+#else
     taa_uilayout_mode mode;
     taa_ui_halign halign;
     taa_ui_valign valign;
+    int spacing;
+    // cell size and number of columns of a grid, zero for other modes
+    int cellw;
+    int cellh;
+    int numcols;
+#endif
     taa_ui_rect rect;
     taa_ui_rect contentrect;
-    int spacing;
     int scrollx;
     int scrolly;
     int parentcmd;
@@ -52,6 +77,47 @@ struct taa_uilayout_cmd_s
     int autoh;
     int childrenw;
     int childrenh;
+    // synthesized height of the children, used by virtualized lists whose
+    // children only cover the visible rows. negative if not virtualized
+    int virtualh;
+};
+
+// a command whose children are being placed by the top-down sweep
+struct taa_uilayout_frame_s
+{
+    int cmd;
+    int end;
+    int scrollx;
+    int scrolly;
+    // rect to clip the children against
+    taa_ui_rect clip;
+    // measures area occupied by the children
+    taa_ui_rect childarea;
+};
+
+// a top-down sweep over the descendants of a command. the top level is
+// swept on the calling thread, and large subtrees may be swept by tasks
+struct taa_uilayout_task_s
+{
+    // the command whose descendants are swept, or -1 for the top level
+    int cmd;
+    // stack used by the sweep, grown to the deepest nesting
+    taa_uilayout_frame* frames;
+    size_t numframes;
+    // scroll bars whose targets are swept by other tasks
+    int* postponed;
+    size_t numpostponed;
+    size_t postponedcapacity;
+    // nonzero if a scroll bar could not be postponed for lack of memory
+    int isoverflowed;
+};
+
+// the arguments shared by the tasks of a frame
+struct taa_uilayout_dispatch_s
+{
+    taa_uilayout_list* list;
+    const taa_ui_style* styles;
+    taa_ui_control* controls;
 };
 
 struct taa_uilayout_list_s
@@ -59,6 +125,27 @@ struct taa_uilayout_list_s
     taa_uilayout_cmd* cmds;
     size_t capacity;
     size_t size;
+    taa_uilayout_task sweep;
+    // nonzero if subtrees that are clipped away entirely are skipped
+    int isculling;
+    // optional callback used to sweep large subtrees in parallel
+    taa_ui_dispatchfunc dispatchfunc;
+    void* dispatchdata;
+    // minimum number of commands in a subtree swept by a task
+    size_t dispatchthreshold;
+    taa_uilayout_task* tasks;
+    size_t numtasks;
+    size_t taskcapacity;
+    // optional callback given each control once it has been placed
+    taa_ui_drawfunc drawfunc;
+    void* drawdata;
+    const taa_ui_controllist* drawctrls;
+    // line breaks of the paragraphs
+    taa_uiwrap_cache wrap;
+    // nonzero once a paragraph has been added. the heights of paragraphs
+    // depend on their widths, so all the widths are then sized before any
+    // of the heights
+    int iswrapping;
 };
 
 //****************************************************************************
@@ -81,19 +168,36 @@ static void taa_uilayout_intersect(
 }
 
 //****************************************************************************
+/**
+ * @brief calculates the smallest rect containing two rects
+ * @details a rect with a negative width or height is empty, and contributes
+ * nothing. areas start out as { INT_MAX, INT_MAX, INT_MIN, INT_MIN }, whose
+ * far edges would otherwise be taken to be at -1.
+ */
 static void taa_uilayout_union(
     const taa_ui_rect* a,
     const taa_ui_rect* b,
     taa_ui_rect* r_out)
 {
-    int xl = (a->x < b->x) ? a->x : b->x;
-    int xr = (a->x+a->w > b->x+b->w) ? a->x+a->w : b->x+b->w;
-    int yt = (a->y < b->y) ? a->y : b->y;
-    int yb = (a->y+a->h > b->y+b->h) ? a->y+a->h : b->y+b->h;
-    r_out->x = xl;
-    r_out->y = yt;
-    r_out->w = xr - xl;
-    r_out->h = yb - yt;
+    if(b->w < 0 || b->h < 0)
+    {
+        *r_out = *a;
+    }
+    else if(a->w < 0 || a->h < 0)
+    {
+        *r_out = *b;
+    }
+    else
+    {
+        int xl = (a->x < b->x) ? a->x : b->x;
+        int xr = (a->x+a->w > b->x+b->w) ? a->x+a->w : b->x+b->w;
+        int yt = (a->y < b->y) ? a->y : b->y;
+        int yb = (a->y+a->h > b->y+b->h) ? a->y+a->h : b->y+b->h;
+        r_out->x = xl;
+        r_out->y = yt;
+        r_out->w = xr - xl;
+        r_out->h = yb - yt;
+    }
 }
 
 //****************************************************************************
@@ -120,6 +224,9 @@ static int taa_uilayout_auto_height(
         case taa_UI_NUMBERBOX:
             h += style->font->charheight;
             break;
+        case taa_UI_PARAGRAPH:
+            h += style->font->charheight * control->data.text.numlines;
+            break;
         case taa_UI_TEXTBOX:
             h += style->font->charheight;
             break;
@@ -147,6 +254,7 @@ static int taa_uilayout_auto_height(
         int childitr = cmd->childbegin;
         int childend = cmd->childend;
         int contenth = 0;
+        int numchildren = 0;
         taa_ui_rect childrect;
         childrect.x = INT_MAX;
         childrect.y = INT_MAX;
@@ -161,6 +269,10 @@ static int taa_uilayout_auto_height(
             {
                 contenth += child->autoh + cmd->spacing;
             }
+            else if(mode == taa_UILAYOUT_GRID)
+            {
+                ++numchildren;
+            }
             else
             {
                 taa_ui_rect tmprect;
@@ -177,6 +289,12 @@ static int taa_uilayout_auto_height(
             // remove it
             contenth -= cmd->spacing;
         }
+        else if(mode == taa_UILAYOUT_GRID)
+        {
+            // the children fill the rows of cells from left to right
+            int numrows = (numchildren + cmd->numcols - 1) / cmd->numcols;
+            contenth = numrows * (cmd->cellh + cmd->spacing) - cmd->spacing;
+        }
         h += contenth;
     }
     return h;
@@ -187,31 +305,37 @@ static int taa_uilayout_auto_width(
     taa_uilayout_cmd* cmds,
     taa_uilayout_cmd* cmd,
     const taa_ui_style* styles,
-    const taa_ui_control* controls)
+    taa_ui_control* controls)
 {
     int w = 0;
     if(cmd->control0 >= 0)
     {
-        const taa_ui_control* control = controls + cmd->control0;
+        taa_ui_control* control = controls + cmd->control0;
         const taa_ui_style* style = styles + control->styleid;
         w = style->lborder+style->lpadding+style->rpadding+style->rborder;
         switch(control->type)
         {
         case taa_UI_BUTTON:
-            w += taa_ui_calc_font_width(
-                style->font,
-                control->data.text.text,
-                control->data.text.textlength);
-            break;
         case taa_UI_LABEL:
-            w += taa_ui_calc_font_width(
+            // the width is kept in the control, so drawing does not need to
+            // measure the text again to align it
+            control->data.text.textwidth = taa_ui_calc_font_width(
                 style->font,
                 control->data.text.text,
                 control->data.text.textlength);
+            w += control->data.text.textwidth;
             break;
         case taa_UI_NUMBERBOX:
             w += style->font->maxcharwidth * control->data.text.textcapacity;
             break;
+        case taa_UI_PARAGRAPH:
+            // the longest line, if the lines were broken before the width
+            // was known. a paragraph that fills adds nothing
+            if(control->data.text.textwidth > 0)
+            {
+                w += control->data.text.textwidth;
+            }
+            break;
         case taa_UI_TEXTBOX:
             w += style->font->maxcharwidth * control->data.text.textcapacity;
             break;
@@ -239,6 +363,7 @@ static int taa_uilayout_auto_width(
         int childitr = cmd->childbegin;
         int childend = cmd->childend;
         int contentw = 0;
+        int numchildren = 0;
         taa_ui_rect childrect;
         childrect.x = INT_MAX;
         childrect.y = INT_MAX;
@@ -253,6 +378,10 @@ static int taa_uilayout_auto_width(
             {
                 contentw += child->autow + cmd->spacing;
             }
+            else if(mode == taa_UILAYOUT_GRID)
+            {
+                ++numchildren;
+            }
             else
             {
                 taa_ui_rect tmprect;
@@ -269,6 +398,13 @@ static int taa_uilayout_auto_width(
             // remove it
             contentw -= cmd->spacing;
         }
+        else if(mode == taa_UILAYOUT_GRID)
+        {
+            // a single row of children may not use all the columns
+            int numcols = cmd->numcols;
+            numcols = (numchildren < numcols) ? numchildren : numcols;
+            contentw = numcols * (cmd->cellw + cmd->spacing) - cmd->spacing;
+        }
         w += contentw;
     }
     return w;
@@ -337,6 +473,43 @@ static void taa_uilayout_abs(
     }
 }
 
+//****************************************************************************
+/**
+ * @brief places a child of a cols command once its width is known
+ */
+static void taa_uilayout_col(
+        taa_uilayout_cmd* cmd,
+        taa_ui_valign valign,
+        const taa_ui_rect* contentrect,
+        int x)
+{
+    if(cmd->rect.h == taa_UI_HEIGHT_FILL)
+    {
+        cmd->rect.h = contentrect->h;
+    }
+    assert(cmd->rect.w >= 0);
+    assert(cmd->rect.h >= 0);
+    cmd->rect.x = x;
+    switch(valign)
+    {
+    case taa_UI_VALIGN_TOP:
+        cmd->rect.y += contentrect->y;
+        break;
+    case taa_UI_VALIGN_BOTTOM:
+        {
+            int yoffset = cmd->rect.y + cmd->rect.h;
+            cmd->rect.y = contentrect->y + contentrect->h - yoffset;
+        }
+        break;
+    case taa_UI_VALIGN_CENTER:
+        {
+            int yoffset = cmd->rect.y - (cmd->rect.h/2);
+            cmd->rect.y = contentrect->y + (contentrect->h/2) + yoffset;
+        }
+        break;
+    }
+}
+
 //****************************************************************************
 static void taa_uilayout_cols(
         taa_uilayout_cmd* cmds,
@@ -347,11 +520,24 @@ static void taa_uilayout_cols(
         int end)
 {
     int itr = begin;
+    int firstfill;
     int fixedw = 0;
     int fillw = 0;
     int numfill = 0;
-    int x = 0;
-    // first pass, determine available fill space and number of fill controls
+    int x = contentrect->x;
+    // the columns before the first fill column do not depend on the fill
+    // width, so they are placed while the fixed width is measured. columns
+    // without any fill are only walked once
+    while(itr != end && cmds[itr].rect.w != taa_UI_WIDTH_FILL)
+    {
+        taa_uilayout_cmd* cmd = cmds + itr;
+        taa_uilayout_col(cmd, valign, contentrect, x);
+        fixedw += cmd->rect.w + spacing;
+        x += cmd->rect.w + spacing;
+        itr = cmd->childend;
+    }
+    firstfill = itr;
+    // determine available fill space and number of fill controls
     while(itr != end)
     {
         taa_uilayout_cmd* cmd = cmds + itr;
@@ -374,9 +560,8 @@ static void taa_uilayout_cols(
     {
         fillw /= numfill;
     }
-    // second pass, set fill widths and calculate coordinates
-    x = contentrect->x;
-    itr = begin;
+    // set fill widths and calculate the remaining coordinates
+    itr = firstfill;
     while(itr != end)
     {
         taa_uilayout_cmd* cmd = cmds + itr;
@@ -384,34 +569,47 @@ static void taa_uilayout_cols(
         {
             cmd->rect.w = fillw;
         }
-        if(cmd->rect.h == taa_UI_HEIGHT_FILL)
+        taa_uilayout_col(cmd, valign, contentrect, x);
+        x += cmd->rect.w + spacing;
+        itr = cmd->childend;
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief places a child of a rows command once its height is known
+ */
+static void taa_uilayout_row(
+        taa_uilayout_cmd* cmd,
+        taa_ui_halign halign,
+        const taa_ui_rect* contentrect,
+        int y)
+{
+    if(cmd->rect.w == taa_UI_WIDTH_FILL)
+    {
+        cmd->rect.w = contentrect->w;
+    }
+    assert(cmd->rect.w >= 0);
+    assert(cmd->rect.h >= 0);
+    switch(halign)
+    {
+    case taa_UI_HALIGN_LEFT:
+        cmd->rect.x += contentrect->x;
+        break;
+    case taa_UI_HALIGN_RIGHT:
         {
-            cmd->rect.h = contentrect->h;
+            int xoffset = cmd->rect.x + cmd->rect.w;
+            cmd->rect.x = contentrect->x + contentrect->w - xoffset;
         }
-        assert(cmd->rect.w >= 0);
-        assert(cmd->rect.h >= 0);
-        cmd->rect.x = x;
-        x += cmd->rect.w + spacing;
-        switch(valign)
+        break;
+    case taa_UI_HALIGN_CENTER:
         {
-        case taa_UI_VALIGN_TOP:
-            cmd->rect.y += contentrect->y;
-            break;
-        case taa_UI_VALIGN_BOTTOM:
-            {
-                int yoffset = cmd->rect.y + cmd->rect.h;
-                cmd->rect.y = contentrect->y + contentrect->h - yoffset;
-            }
-            break;
-        case taa_UI_VALIGN_CENTER:
-            {
-                int yoffset = cmd->rect.y - (cmd->rect.h/2);
-                cmd->rect.y = contentrect->y + (contentrect->h/2) + yoffset;
-            }
-            break;
+            int xoffset = cmd->rect.x - (cmd->rect.w/2);
+            cmd->rect.x = contentrect->x + (contentrect->w/2) + xoffset;
         }
-        itr = cmd->childend;
+        break;
     }
+    cmd->rect.y = y;
 }
 
 //****************************************************************************
@@ -424,11 +622,24 @@ static void taa_uilayout_rows(
         int end)
 {
     int itr = begin;
+    int firstfill;
     int fixedh = 0;
     int fillh = 0;
     int numfill = 0;
-    int y = 0;
-    // first pass, determine available fill space and number of fill controls
+    int y = contentrect->y;
+    // the rows before the first fill row do not depend on the fill height,
+    // so they are placed while the fixed height is measured. rows without
+    // any fill, such as long lists, are only walked once
+    while(itr != end && cmds[itr].rect.h != taa_UI_HEIGHT_FILL)
+    {
+        taa_uilayout_cmd* cmd = cmds + itr;
+        taa_uilayout_row(cmd, halign, contentrect, y);
+        fixedh += cmd->rect.h + spacing;
+        y += cmd->rect.h + spacing;
+        itr = cmd->childend;
+    }
+    firstfill = itr;
+    // determine available fill space and number of fill controls
     while(itr != end)
     {
         taa_uilayout_cmd* cmd = cmds + itr;
@@ -451,178 +662,734 @@ static void taa_uilayout_rows(
     {
         fillh /= numfill;
     }
-    // second pass, set fill widths and calculate coordinates
-    y = contentrect->y;
-    itr = begin;
+    // set fill heights and calculate the remaining coordinates
+    itr = firstfill;
     while(itr != end)
     {
         taa_uilayout_cmd* cmd = cmds + itr;
-        if(cmd->rect.w == taa_UI_WIDTH_FILL)
-        {
-            cmd->rect.w = contentrect->w;
-        }
         if(cmd->rect.h == taa_UI_HEIGHT_FILL)
         {
             cmd->rect.h = fillh;
         }
-        assert(cmd->rect.w >= 0);
-        assert(cmd->rect.h >= 0);
-        switch(halign)
-        {
-        case taa_UI_HALIGN_LEFT:
-            cmd->rect.x += contentrect->x;
-            break;
-        case taa_UI_HALIGN_RIGHT:
-            {
-                int xoffset = cmd->rect.x + cmd->rect.w;
-                cmd->rect.x = contentrect->x + contentrect->w - xoffset;
-            }
-            break;
-        case taa_UI_HALIGN_CENTER:
-            {
-                int xoffset = cmd->rect.x - (cmd->rect.w/2);
-                cmd->rect.x = contentrect->x + (contentrect->w/2) + xoffset;
-            }
-            break;
-        }
-        cmd->rect.y = y;
+        taa_uilayout_row(cmd, halign, contentrect, y);
         y += cmd->rect.h + spacing;
         itr = cmd->childend;
     }
 }
 
 //****************************************************************************
-static void taa_uilayout_pass0(
+/**
+ * @brief places the children of a grid, each within its own cell
+ * @details the cell of the child with ordinal k is in column k % numcols
+ * and row k / numcols, so no child depends on the size of its siblings.
+ * children are positioned within their cells as in absolute mode.
+ */
+static void taa_uilayout_grid(
+        taa_uilayout_cmd* cmds,
+        const taa_uilayout_cmd* grid,
+        const taa_ui_rect* contentrect,
+        int begin,
+        int end)
+{
+    int itr = begin;
+    int col = 0;
+    taa_ui_rect cellrect;
+    cellrect.x = contentrect->x;
+    cellrect.y = contentrect->y;
+    cellrect.w = grid->cellw;
+    cellrect.h = grid->cellh;
+    while(itr != end)
+    {
+        int next = cmds[itr].childend;
+        taa_uilayout_abs(
+            cmds,
+            grid->halign,
+            grid->valign,
+            &cellrect,
+            itr,
+            next);
+        // step to the next cell, wrapping to the start of the next row
+        ++col;
+        cellrect.x += grid->cellw + grid->spacing;
+        if(col == grid->numcols)
+        {
+            col = 0;
+            cellrect.x = contentrect->x;
+            cellrect.y += grid->cellh + grid->spacing;
+        }
+        itr = next;
+    }
+}
+
+//****************************************************************************
+static void taa_uilayout_size_width(
     taa_uilayout_cmd* cmds,
+    taa_uilayout_cmd* cmd,
+    const taa_ui_style* styles,
+    taa_ui_control* controls)
+{
+    // called once the children have been sized. compute width of control
+    switch(cmd->rect.w)
+    {
+    case taa_UI_WIDTH_AUTO:
+        cmd->autow = taa_uilayout_auto_width(cmds,cmd,styles,controls);
+        cmd->rect.w = cmd->autow;
+        break;
+    case taa_UI_WIDTH_DEFAULT:
+        if(cmd->control0 >= 0)
+        {
+            const taa_ui_control* control = controls + cmd->control0;
+            const taa_ui_style* style = styles + control->styleid;
+            cmd->rect.w = style->defaultw;
+        }
+        else
+        {
+            cmd->rect.w = 0;
+        }
+        cmd->autow = cmd->rect.w;
+        break;
+    case taa_UI_WIDTH_FILL:
+        cmd->autow = taa_uilayout_auto_width(cmds,cmd,styles,controls);
+        break;
+    default:
+        cmd->autow = cmd->rect.w;
+        break;
+    }
+}
+
+//****************************************************************************
+static void taa_uilayout_size_height(
+    taa_uilayout_cmd* cmds,
+    taa_uilayout_cmd* cmd,
+    const taa_ui_style* styles,
+    const taa_ui_control* controls)
+{
+    // called once the children have been sized. compute height of control
+    switch(cmd->rect.h)
+    {
+    case taa_UI_HEIGHT_AUTO:
+        cmd->autoh = taa_uilayout_auto_height(cmds,cmd,styles,controls);
+        cmd->rect.h = cmd->autoh;
+        break;
+    case taa_UI_HEIGHT_DEFAULT:
+        if(cmd->control0 >= 0)
+        {
+            const taa_ui_control* control = controls + cmd->control0;
+            const taa_ui_style* style = styles + control->styleid;
+            cmd->rect.h = style->defaulth;
+        }
+        else
+        {
+            cmd->rect.h = 0;
+        }
+        cmd->autoh = cmd->rect.h;
+        break;
+    case taa_UI_HEIGHT_FILL:
+        cmd->autoh = taa_uilayout_auto_height(cmds,cmd,styles,controls);
+        break;
+    default:
+        cmd->autoh = cmd->rect.h;
+        break;
+    }
+}
+
+//****************************************************************************
+static void taa_uilayout_size(
+    taa_uilayout_cmd* cmds,
+    taa_uilayout_cmd* cmd,
+    const taa_ui_style* styles,
+    taa_ui_control* controls)
+{
+    taa_uilayout_size_width(cmds, cmd, styles, controls);
+    taa_uilayout_size_height(cmds, cmd, styles, controls);
+}
+
+//****************************************************************************
+/**
+ * @brief calculates the width pass1 will give a command set to fill
+ * @details must be called once all the widths have been sized. the fill
+ * width only depends on the widths of the parent and the siblings, and
+ * the content width of the parent is found the same way if it also fills.
+ */
+static int taa_uilayout_fill_width(
+    const taa_uilayout_cmd* cmds,
+    const taa_uilayout_cmd* cmd,
     const taa_ui_style* styles,
     const taa_ui_control* controls,
-    taa_ui_halign halign,
-    taa_ui_valign valign,
-    int begin,
-    int end)
+    int screenw)
 {
-    // recursive bottom-up calculation of fixed sized control dimensions
-    int itr = begin;
-    while(itr != end)
+    int w = screenw;
+    if(cmd->parentcmd >= 0)
     {
-        taa_uilayout_cmd* cmd = cmds + itr;
-        int childbegin = cmd->childbegin;
-        int childend = cmd->childend;
-        // recursively process all children first
-        if(childbegin != childend)
+        const taa_uilayout_cmd* parent = cmds + cmd->parentcmd;
+        w = parent->rect.w;
+        if(w == taa_UI_WIDTH_FILL)
         {
-            taa_uilayout_pass0(
+            w = taa_uilayout_fill_width(
                 cmds,
+                parent,
                 styles,
                 controls,
-                cmd->halign,
-                cmd->valign,
-                childbegin,
-                childend);
+                screenw);
         }
-        // after children have been sized, compute width of current control
-        switch(cmd->rect.w)
+        if(parent->control0 >= 0)
         {
-        case taa_UI_WIDTH_AUTO:
-            cmd->autow = taa_uilayout_auto_width(cmds,cmd,styles,controls);
-            cmd->rect.w = cmd->autow;
-            break;
-        case taa_UI_WIDTH_DEFAULT:
-            if(cmd->control0 >= 0)
-            {
-                const taa_ui_control* control = controls + cmd->control0;
-                const taa_ui_style* style = styles + control->styleid;
-                cmd->rect.w = style->defaultw;
-            }
-            else
+            const taa_ui_control* control = controls + parent->control0;
+            const taa_ui_style* style = styles + control->styleid;
+            w -= style->lborder + style->lpadding;
+            w -= style->rborder + style->rpadding;
+            w = (w > 0) ? w : 0;
+        }
+        if(parent->mode == taa_UILAYOUT_COLS)
+        {
+            // the space left by the other columns is shared by the fills
+            int itr = parent->childbegin;
+            int fixedw = -parent->spacing;
+            int numfill = 0;
+            while(itr != parent->childend)
             {
-                cmd->rect.w = 0;
+                const taa_uilayout_cmd* sibling = cmds + itr;
+                if(sibling->rect.w == taa_UI_WIDTH_FILL)
+                {
+                    ++numfill;
+                }
+                else
+                {
+                    fixedw += sibling->rect.w;
+                }
+                fixedw += parent->spacing;
+                itr = sibling->childend;
             }
-            cmd->autow = cmd->rect.w;
-            break;
-        case taa_UI_WIDTH_FILL:
-            cmd->autow = taa_uilayout_auto_width(cmds,cmd,styles,controls);
-            break;
-        default:
-            cmd->autow = cmd->rect.w;
-            break;
+            w = (w > fixedw) ? w - fixedw : 0;
+            w /= numfill;
         }
-        // compute height of control
-        switch(cmd->rect.h)
+        else if(parent->mode == taa_UILAYOUT_GRID)
         {
-        case taa_UI_HEIGHT_AUTO:
-            cmd->autoh = taa_uilayout_auto_height(cmds,cmd,styles,controls);
-            cmd->rect.h = cmd->autoh;
-            break;
-        case taa_UI_HEIGHT_DEFAULT:
-            if(cmd->control0 >= 0)
+            w = parent->cellw;
+        }
+    }
+    return w;
+}
+
+//****************************************************************************
+/**
+ * @brief breaks the text of a paragraph into lines that fit a width
+ * @param width width of the paragraph, or INT_MAX to only break the text
+ *        at newlines
+ */
+static void taa_uilayout_wrap(
+    taa_uilayout_list* list,
+    const taa_ui_style* styles,
+    taa_ui_control* control,
+    int width)
+{
+    const taa_ui_style* style = styles + control->styleid;
+    const taa_uiwrap_entry* entry;
+    if(width != INT_MAX)
+    {
+        width -= style->lborder + style->lpadding;
+        width -= style->rborder + style->rpadding;
+        width = (width > 0) ? width : 0;
+    }
+    entry = taa_uiwrap_find(
+        &list->wrap,
+        style->font,
+        control->data.text.text,
+        control->data.text.textlength,
+        width);
+    control->data.text.textwidth = entry->maxwidth;
+    control->data.text.numlines = entry->numlines;
+    control->data.text.lines = entry->lines;
+}
+
+//****************************************************************************
+static void taa_uilayout_pass0(
+    taa_uilayout_list* list,
+    const taa_ui_style* styles,
+    taa_ui_control* controls,
+    const taa_ui_rect* screenrect)
+{
+    // bottom-up calculation of fixed sized control dimensions. commands are
+    // stored in pre-order, so every command follows its parent. sweeping
+    // the list in reverse sizes all children before their parents.
+    taa_uilayout_cmd* cmds = list->cmds;
+    int itr = (int) list->size;
+    if(!list->iswrapping)
+    {
+        while(itr > 0)
+        {
+            taa_uilayout_cmd* cmd;
+            --itr;
+            cmd = cmds + itr;
+            taa_uilayout_size(cmds, cmd, styles, controls);
+        }
+    }
+    else
+    {
+        // widths never depend on heights, so the widths are sized by one
+        // sweep and the heights by another. in between, the final width
+        // of every paragraph is known, and its lines are broken to fit
+        taa_uiwrap_begin(&list->wrap);
+        while(itr > 0)
+        {
+            taa_uilayout_cmd* cmd;
+            --itr;
+            cmd = cmds + itr;
+            if(cmd->control0 >= 0 &&
+               controls[cmd->control0].type == taa_UI_PARAGRAPH)
             {
-                const taa_ui_control* control = controls + cmd->control0;
-                const taa_ui_style* style = styles + control->styleid;
-                cmd->rect.h = style->defaulth;
+                // an auto width fits the text as broken at newlines. the
+                // lines of other paragraphs wait for their final width
+                taa_ui_control* control = controls + cmd->control0;
+                control->data.text.textwidth = -1;
+                control->data.text.numlines = 0;
+                control->data.text.lines = NULL;
+                if(cmd->rect.w == taa_UI_WIDTH_AUTO)
+                {
+                    taa_uilayout_wrap(list, styles, control, INT_MAX);
+                }
             }
-            else
+            taa_uilayout_size_width(cmds, cmd, styles, controls);
+        }
+        itr = (int) list->size;
+        while(itr > 0)
+        {
+            taa_uilayout_cmd* cmd;
+            --itr;
+            cmd = cmds + itr;
+            if(cmd->control0 >= 0 &&
+               controls[cmd->control0].type == taa_UI_PARAGRAPH &&
+               controls[cmd->control0].data.text.lines == NULL)
             {
-                cmd->rect.h = 0;
+                int w = cmd->rect.w;
+                if(w == taa_UI_WIDTH_FILL)
+                {
+                    w = taa_uilayout_fill_width(
+                        cmds,
+                        cmd,
+                        styles,
+                        controls,
+                        screenrect->w);
+                }
+                taa_uilayout_wrap(list, styles, controls+cmd->control0, w);
             }
-            cmd->autoh = cmd->rect.h;
-            break;
-        case taa_UI_HEIGHT_FILL:
-            cmd->autoh = taa_uilayout_auto_height(cmds,cmd,styles,controls);
-            break;
-        default:
-            cmd->autow = cmd->rect.w;
-            break;
+            taa_uilayout_size_height(cmds, cmd, styles, controls);
         }
-        itr = childend;
-        assert((itr == end) || (cmds[itr].parentcmd == cmd->parentcmd));
     }
 }
 
 //****************************************************************************
-static void taa_uilayout_pass1(
+static void taa_uilayout_place(
     taa_uilayout_cmd* cmds,
-    const taa_ui_style* styles,
-    taa_ui_control* controls,
     taa_uilayout_mode mode,
     taa_ui_halign halign,
     taa_ui_valign valign,
     int spacing,
-    int scrollx,
-    int scrolly,
-    const taa_ui_rect* parentrect,
-    const taa_ui_rect* parentclip,
-    taa_ui_rect* parentarea,
+    const taa_ui_rect* contentrect,
     int begin,
     int end)
 {
-    // recursive top-down calculation of filled control dimensions, screen
-    // space positions, and clip rectangles
-    int itr;
-    // calculate size and layout of all the controls at this level first
+    // calculates the size and position of a range of sibling commands
     switch(mode)
     {
     case taa_UILAYOUT_ABS:
-        taa_uilayout_abs(cmds, halign, valign, parentrect, begin, end);
+        taa_uilayout_abs(cmds, halign, valign, contentrect, begin, end);
         break;
     case taa_UILAYOUT_COLS:
-        taa_uilayout_cols(cmds, valign, spacing, parentrect, begin, end);
+        taa_uilayout_cols(cmds, valign, spacing, contentrect, begin, end);
         break;
     case taa_UILAYOUT_ROWS:
-        taa_uilayout_rows(cmds, halign, spacing, parentrect, begin, end);
+        taa_uilayout_rows(cmds, halign, spacing, contentrect, begin, end);
         break;
+    case taa_UILAYOUT_GRID:
+        // the cell dimensions are read from the grid command, which is the
+        // parent of the range
+        assert(begin != end);
+        taa_uilayout_grid(
+            cmds,
+            cmds + cmds[begin].parentcmd,
+            contentrect,
+            begin,
+            end);
+        break;
+    }
+}
+
+//****************************************************************************
+static void taa_uilayout_close(
+    taa_uilayout_cmd* cmd,
+    const taa_ui_rect* childarea,
+    taa_ui_rect* parentarea)
+{
+    // called once all the descendants of a command have been placed
+    cmd->childrenw = (childarea->w >= 0) ? childarea->w : 0;
+    cmd->childrenh = (childarea->h >= 0) ? childarea->h : 0;
+    if(cmd->virtualh >= 0)
+    {
+        cmd->childrenh = cmd->virtualh;
+    }
+    if(cmd->control0 >= 0)
+    {
+        // if a control command, propogate area to parent
+        taa_uilayout_union(parentarea, &cmd->rect, parentarea);
+    }
+    else
+    {
+        // if a pure layout command, propogate child area to parent
+        taa_uilayout_union(parentarea, childarea, parentarea);
     }
-    // export layout to controls and recurse into children
-    itr = begin;
+}
+
+//****************************************************************************
+/**
+ * @brief marks the controls of a subtree that is clipped away
+ * @details the rect of the command at the root was placed with its
+ * siblings, and is kept so that it still counts toward the area of its
+ * parent. the descendants are not placed, and are given empty rects.
+ */
+static void taa_uilayout_cull(
+    taa_uilayout_cmd* cmds,
+    int cmdindex,
+    taa_ui_control* controls)
+{
+    static const taa_ui_rect emptyrect = { 0, 0, 0, 0 };
+    taa_uilayout_cmd* cmd = cmds + cmdindex;
+    taa_uilayout_cmd* cmdend = cmds + cmd->childend;
+    while(cmd != cmdend)
+    {
+        if(cmd != cmds + cmdindex)
+        {
+            cmd->rect = emptyrect;
+            cmd->contentrect = emptyrect;
+        }
+        cmd->childrenw = 0;
+        cmd->childrenh = 0;
+        if(cmd->control0 >= 0)
+        {
+            taa_ui_control* control = controls + cmd->control0;
+            control->rect = cmd->rect;
+            control->cliprect = emptyrect;
+            control->flags |= taa_UI_FLAG_CULLED;
+        }
+        if(cmd->control1 >= 0)
+        {
+            taa_ui_control* control = controls + cmd->control1;
+            control->rect = cmd->rect;
+            control->cliprect = emptyrect;
+            control->flags |= taa_UI_FLAG_CULLED;
+        }
+        ++cmd;
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief calculates the slider of a vertical scroll bar from its target
+ * @details the target precedes the scroll bar in the list, so it has
+ * already been closed
+ */
+static void taa_uilayout_scrollbar(
+    const taa_uilayout_cmd* cmds,
+    const taa_uilayout_cmd* cmd,
+    const taa_ui_style* styles,
+    taa_ui_control* control,
+    const taa_ui_rect* contentrect)
+{
+    const taa_uilayout_cmd* targetcmd = cmds + cmd->targetcmd;
+    const taa_ui_style* ss;
+    taa_ui_rect sliderrect;
+    int range; // maximum scroll value
+    int value; // current scroll value
+    int slidermax; // maximum height of slider
+    int slidermin; // minimum height of slider
+    int sliderh; // height of slider
+    int sliderrange; // amount that slider can move
+    ss = styles + control->data.scroll.sliderstyleid;
+    range = targetcmd->childrenh - targetcmd->contentrect.h;
+    slidermax = contentrect->h;
+    slidermin = ss->tborder+ss->tpadding+ss->bpadding+ss->bborder;
+    sliderh = (range>0) ? (slidermax*slidermax)/range : slidermax;
+    sliderh = (sliderh >= slidermin) ? sliderh : slidermin;
+    sliderh = (sliderh <= slidermax) ? sliderh : slidermax;
+    sliderrange = slidermax - sliderh;
+    sliderrect = *contentrect;
+    sliderrect.h = sliderh;
+    value = control->data.scroll.value;
+    if(sliderh > 0 && sliderrange > 0 && range > slidermax)
+    {
+        // if scrollable
+        sliderrect.y += (value*sliderrange)/range;
+    }
+    control->data.scroll.range = range;
+    control->data.scroll.sliderrect = sliderrect;
+    control->data.scroll.sliderpane = *contentrect;
+}
+
+//****************************************************************************
+/**
+ * @brief finds the task that sweeps a command
+ * @return index of the task, or -1 if it is swept by the top level
+ */
+static int taa_uilayout_find_task(
+    const taa_uilayout_list* list,
+    int cmdindex)
+{
+    int result = -1;
+    size_t i;
+    for(i = 0; i < list->numtasks; ++i)
+    {
+        int root = list->tasks[i].cmd;
+        if(cmdindex >= root && cmdindex < list->cmds[root].childend)
+        {
+            result = (int) i;
+            break;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief passes the controls of a command to the draw callback as the
+ * sweep enters the command
+ * @details the second control of a command was added once its children
+ * were, so it is drawn first, and the first control is drawn when the
+ * command is closed. a command with a single control draws it right away.
+ */
+static void taa_uilayout_draw_open(
+    taa_uilayout_list* list,
+    const taa_uilayout_cmd* cmd,
+    const taa_ui_control* controls)
+{
+    if(cmd->control1 >= 0)
+    {
+        list->drawfunc(list->drawdata,list->drawctrls,controls+cmd->control1);
+    }
+    else if(cmd->control0 >= 0)
+    {
+        list->drawfunc(list->drawdata,list->drawctrls,controls+cmd->control0);
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief passes the first control of a command with two controls to the
+ * draw callback, once all of its descendants have been drawn
+ */
+static void taa_uilayout_draw_close(
+    taa_uilayout_list* list,
+    const taa_uilayout_cmd* cmd,
+    const taa_ui_control* controls)
+{
+    if(cmd->control1 >= 0 && cmd->control0 >= 0)
+    {
+        list->drawfunc(list->drawdata,list->drawctrls,controls+cmd->control0);
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief determines if the descendants of a control are swept by a task
+ * @details a subtree is given to a task if it holds at least threshold
+ * commands, unless it contains a smaller control subtree that does. the
+ * search only descends into the subtrees above the threshold.
+ */
+static int taa_uilayout_is_task(
+    const taa_uilayout_cmd* cmds,
+    int cmdindex,
+    size_t threshold)
+{
+    const taa_uilayout_cmd* cmd = cmds + cmdindex;
+    int itr = cmd->childbegin;
+    int end = cmd->childend;
+    int result = ((size_t) (end - cmdindex)) >= threshold;
+    while(result && itr != end)
+    {
+        const taa_uilayout_cmd* child = cmds + itr;
+        if(((size_t) (child->childend - itr)) < threshold)
+        {
+            itr = child->childend;
+        }
+        else if(child->control0 >= 0)
+        {
+            result = 0;
+        }
+        else
+        {
+            // pure layout commands are not split into tasks, since their
+            // parents depend on the area of their children
+            ++itr;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief hands the descendants of a command to a new task
+ * @param frame the frame opened for the children of the command, which
+ *        have already been placed
+ * @return nonzero if a task was added, or zero if there was no memory for
+ *         one, in which case the caller sweeps the descendants itself
+ */
+static int taa_uilayout_defer(
+    taa_uilayout_list* list,
+    const taa_uilayout_frame* frame)
+{
+    taa_uilayout_task* task;
+    int result = 0;
+    if(list->numtasks == list->taskcapacity)
+    {
+        size_t capacity = (list->taskcapacity > 0) ? list->taskcapacity*2 : 8;
+        taa_uilayout_task* tasks = (taa_uilayout_task*) realloc(
+            list->tasks,
+            capacity * sizeof(*list->tasks));
+        if(tasks != NULL)
+        {
+            memset(
+                tasks + list->taskcapacity,
+                0,
+                (capacity - list->taskcapacity) * sizeof(*tasks));
+            list->tasks = tasks;
+            list->taskcapacity = capacity;
+        }
+    }
+    if(list->numtasks < list->taskcapacity)
+    {
+        task = list->tasks + list->numtasks;
+        if(task->frames == NULL)
+        {
+            task->frames = (taa_uilayout_frame*) malloc(
+                16 * sizeof(*task->frames));
+            task->numframes = (task->frames != NULL) ? 16 : 0;
+        }
+        if(task->frames != NULL)
+        {
+            task->cmd = frame->cmd;
+            task->frames[0] = *frame;
+            task->numpostponed = 0;
+            task->isoverflowed = 0;
+            ++list->numtasks;
+            result = 1;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief records a scroll bar whose slider must wait for the other tasks
+ * @details if there is no memory to record it, the task is marked instead,
+ * and the join updates every scroll bar of the task
+ */
+static void taa_uilayout_postpone(
+    taa_uilayout_task* task,
+    int cmdindex)
+{
+    if(task->numpostponed == task->postponedcapacity)
+    {
+        size_t capacity = task->postponedcapacity;
+        int* postponed;
+        capacity = (capacity > 0) ? capacity * 2 : 8;
+        postponed = (int*) realloc(
+            task->postponed,
+            capacity * sizeof(*task->postponed));
+        if(postponed != NULL)
+        {
+            task->postponed = postponed;
+            task->postponedcapacity = capacity;
+        }
+    }
+    if(task->numpostponed < task->postponedcapacity)
+    {
+        task->postponed[task->numpostponed] = cmdindex;
+        ++task->numpostponed;
+    }
+    else
+    {
+        task->isoverflowed = 1;
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief grows the stack of a task to hold a number of frames
+ * @details the stack is only ever one frame short, so it is doubled once
+ * @return nonzero if the stack holds numframes frames
+ */
+static int taa_uilayout_reserve_frames(
+    taa_uilayout_task* task,
+    size_t numframes)
+{
+    int result = 1;
+    if(numframes > task->numframes)
+    {
+        size_t capacity = task->numframes * 2;
+        taa_uilayout_frame* frames = (taa_uilayout_frame*) realloc(
+            task->frames,
+            capacity * sizeof(*task->frames));
+        if(frames != NULL)
+        {
+            task->frames = frames;
+            task->numframes = capacity;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+static void taa_uilayout_sweep(
+    taa_uilayout_list* list,
+    taa_uilayout_task* task,
+    const taa_ui_style* styles,
+    taa_ui_control* controls)
+{
+    // top-down calculation of filled control dimensions, screen space
+    // positions, and clip rectangles. the descendants of the command at
+    // the bottom of the stack are swept forward, keeping a stack of the
+    // commands whose descendants are still being placed. a command is
+    // closed once the sweep reaches the end of its children. the bottom
+    // frame is set up by the caller, with its children already placed
+    taa_uilayout_cmd* cmds = list->cmds;
+    taa_uilayout_frame* frames = task->frames;
+    taa_ui_rect emptyarea = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    int istask = (task != &list->sweep);
+    int taskindex = istask ? (int) (task - list->tasks) : -1;
+    int depth = 0;
+    int itr = frames[0].cmd + 1;
+    int end = frames[0].end;
     while(itr != end)
     {
         taa_uilayout_cmd* cmd = cmds + itr;
+        const taa_uilayout_frame* parent;
         int childbegin = cmd->childbegin;
         int childend = cmd->childend;
         taa_ui_rect cliprect;  // rect this command is clipped against
         taa_ui_rect contentrect; // used for child positioning and clipping
-        taa_ui_rect contentclip; // rect to clip child commands against
-        taa_ui_rect childarea; // measures area occupied by children
+        int isculled;
+        while(frames[depth].end <= itr)
+        {
+            // close the commands whose children have all been placed
+            taa_uilayout_close(
+                cmds + frames[depth].cmd,
+                &frames[depth].childarea,
+                &frames[depth-1].childarea);
+            if(list->drawfunc != NULL)
+            {
+                // the end of the command is drawn over its descendants
+                taa_uilayout_draw_close(
+                    list,
+                    cmds + frames[depth].cmd,
+                    controls);
+            }
+            --depth;
+        }
+        parent = frames + depth;
+        assert(cmd->parentcmd == parent->cmd);
         // adjust for scroll
         if(cmd->control0 >= 0)
         {
@@ -643,42 +1410,29 @@ static void taa_uilayout_pass1(
             {
                 contentrect.h = 0;
             }
-            taa_uilayout_intersect(&cmd->rect, parentclip, &cliprect);
+            taa_uilayout_intersect(&cmd->rect, &parent->clip, &cliprect);
             // export layout to control
             control->rect = cmd->rect;
             control->cliprect = cliprect;
             if(control->type == taa_UI_VSCROLLBAR && cmd->targetcmd >= 0)
             {
                 // if it's a vertical scrollbar, the slider rect and range
-                // need to be calculated
-                taa_uilayout_cmd* targetcmd = cmds + cmd->targetcmd;
-                const taa_ui_style* ss;
-                taa_ui_rect sliderrect;
-                int range; // maximum scroll value
-                int value; // current scroll value
-                int slidermax; // maximum height of slider
-                int slidermin; // minimum height of slider
-                int sliderh; // height of slider
-                int sliderrange; // amount that slider can move
-                ss = styles + control->data.scroll.sliderstyleid;
-                range = targetcmd->childrenh - targetcmd->contentrect.h;
-                slidermax = contentrect.h;
-                slidermin = ss->tborder+ss->tpadding+ss->bpadding+ss->bborder;
-                sliderh = (range>0) ? (slidermax*slidermax)/range : slidermax;
-                sliderh = (sliderh >= slidermin) ? sliderh : slidermin;
-                sliderh = (sliderh <= slidermax) ? sliderh : slidermax;
-                sliderrange = slidermax - sliderh;
-                sliderrect = contentrect;
-                sliderrect.h = sliderh;
-                value = control->data.scroll.value;
-                if(sliderh > 0 && sliderrange > 0 && range > slidermax)
+                // need to be calculated, unless its target is still
+                // waiting to be swept by another task
+                int targettask = taa_uilayout_find_task(list,cmd->targetcmd);
+                if(targettask < 0 || targettask == taskindex)
+                {
+                    taa_uilayout_scrollbar(
+                        cmds,
+                        cmd,
+                        styles,
+                        control,
+                        &contentrect);
+                }
+                else
                 {
-                    // if scrollable
-                    sliderrect.y += (value*sliderrange)/range;
+                    taa_uilayout_postpone(task, itr);
                 }
-                control->data.scroll.range = range;
-                control->data.scroll.sliderrect = sliderrect;
-                control->data.scroll.sliderpane = contentrect;
             }
             if(cmd->control1 >= 0)
             {
@@ -692,50 +1446,261 @@ static void taa_uilayout_pass1(
         else
         {
             contentrect = cmd->rect;
-            taa_uilayout_intersect(&cmd->rect, parentclip, &cliprect);
+            taa_uilayout_intersect(&cmd->rect, &parent->clip, &cliprect);
         }
         // export content size to cmd
         cmd->contentrect = contentrect;
-        // after current control is calculated, descend into children
-        childarea.x = INT_MAX;
-        childarea.y = INT_MAX;
-        childarea.w = INT_MIN;
-        childarea.h = INT_MIN;
-        if(childbegin != childend)
-        {
-            taa_uilayout_intersect(&contentrect, &cliprect, &contentclip);
-            contentrect.x -= scrollx;
-            contentrect.y -= scrolly;
-            taa_uilayout_pass1(
+        // a control that is clipped away hides its whole subtree. pure
+        // layout commands are still placed, since their children count
+        // toward the area of their parent
+        isculled =
+            list->isculling &&
+            cmd->control0 >= 0 &&
+            (cliprect.w <= 0 || cliprect.h <= 0);
+        if(!isculled &&
+           childbegin != childend &&
+           !taa_uilayout_reserve_frames(task, (size_t) depth + 2))
+        {
+            // there is no memory to sweep any deeper, so the subtree is
+            // hidden as if it were clipped away
+            isculled = 1;
+        }
+        frames = task->frames;
+        parent = frames + depth;
+        if(list->drawfunc != NULL && !isculled)
+        {
+            // the rects and data of the controls of the command are final,
+            // so they are drawn while still in the cache
+            taa_uilayout_draw_open(list, cmd, controls);
+        }
+        if(isculled)
+        {
+            // the subtree is not walked
+            taa_uilayout_cull(cmds, itr, controls);
+            taa_uilayout_union(
+                &frames[depth].childarea,
+                &cmd->rect,
+                &frames[depth].childarea);
+            itr = childend;
+        }
+        else if(childbegin != childend)
+        {
+            // open a frame for the children, which are placed within the
+            // content rect before the sweep continues into them
+            taa_uilayout_frame* frame;
+            ++depth;
+            frame = frames + depth;
+            frame->cmd = itr;
+            frame->end = childend;
+            frame->scrollx = cmd->scrollx;
+            frame->scrolly = cmd->scrolly;
+            frame->childarea = emptyarea;
+            taa_uilayout_intersect(&contentrect, &cliprect, &frame->clip);
+            contentrect.x -= parent->scrollx;
+            contentrect.y -= parent->scrolly;
+            taa_uilayout_place(
                 cmds,
-                styles,
-                controls,
                 cmd->mode,
                 cmd->halign,
                 cmd->valign,
                 cmd->spacing,
-                cmd->scrollx,
-                cmd->scrolly,
                 &contentrect,
-                &contentclip,
-                &childarea,
                 childbegin,
                 childend);
+            if(!istask &&
+               list->dispatchfunc != NULL &&
+               list->drawfunc == NULL &&
+               cmd->control0 >= 0 &&
+               taa_uilayout_is_task(cmds, itr, list->dispatchthreshold) &&
+               taa_uilayout_defer(list, frame))
+            {
+                // the children only depend on the frame, and the parent
+                // only depends on the rect of the control, so the rest of
+                // the subtree is left to a task
+                --depth;
+                taa_uilayout_union(
+                    &frames[depth].childarea,
+                    &cmd->rect,
+                    &frames[depth].childarea);
+                itr = childend;
+            }
+            else
+            {
+                ++itr;
+            }
         }
-        cmd->childrenw = (childarea.w >= 0) ? childarea.w : 0;
-        cmd->childrenh = (childarea.h >= 0) ? childarea.h : 0;
-        if(cmd->control0 >= 0)
+        else
         {
-            // if a control command, propogate area to parent
-            taa_uilayout_union(parentarea, &cmd->rect, parentarea);
+            // without children, the command can be closed immediately
+            taa_uilayout_close(
+                cmd,
+                &emptyarea,
+                &frames[depth].childarea);
+            if(list->drawfunc != NULL)
+            {
+                taa_uilayout_draw_close(list, cmd, controls);
+            }
+            ++itr;
         }
-        else
+    }
+    while(depth > 0)
+    {
+        taa_uilayout_close(
+            cmds + frames[depth].cmd,
+            &frames[depth].childarea,
+            &frames[depth-1].childarea);
+        if(list->drawfunc != NULL)
+        {
+            taa_uilayout_draw_close(list, cmds+frames[depth].cmd, controls);
+        }
+        --depth;
+    }
+    if(istask)
+    {
+        // the rect of the command at the root was already added to the
+        // area of its parent, so only the command itself is closed
+        taa_ui_rect parentarea = emptyarea;
+        taa_uilayout_close(
+            cmds + frames[0].cmd,
+            &frames[0].childarea,
+            &parentarea);
+    }
+}
+
+//****************************************************************************
+static void taa_uilayout_run_task(
+    void* args,
+    int index)
+{
+    taa_uilayout_dispatch* dispatch = (taa_uilayout_dispatch*) args;
+    taa_uilayout_sweep(
+        dispatch->list,
+        dispatch->list->tasks + index,
+        dispatch->styles,
+        dispatch->controls);
+}
+
+//****************************************************************************
+/**
+ * @brief completes the work that depends on more than one task
+ * @details called once all the tasks have returned
+ */
+static void taa_uilayout_join(
+    taa_uilayout_list* list,
+    const taa_ui_style* styles,
+    taa_ui_control* controls)
+{
+    taa_uilayout_cmd* cmds = list->cmds;
+    size_t i;
+    for(i = 0; i <= list->numtasks; ++i)
+    {
+        // the top level sweep is joined along with the tasks
+        taa_uilayout_task* task = list->tasks + i;
+        size_t j;
+        if(i == list->numtasks)
+        {
+            task = &list->sweep;
+        }
+        for(j = 0; j < task->numpostponed; ++j)
         {
-            // if a pure layout command, propogate child area to parent
-            taa_uilayout_union(parentarea, &childarea, parentarea);            
+            taa_uilayout_cmd* cmd = cmds + task->postponed[j];
+            taa_uilayout_scrollbar(
+                cmds,
+                cmd,
+                styles,
+                controls + cmd->control0,
+                &cmd->contentrect);
         }
-        itr = childend;
-        assert((itr == end) || (cmds[itr].parentcmd == cmd->parentcmd));
+        if(task->isoverflowed)
+        {
+            // not every postponed scroll bar of the task was recorded, so
+            // all the scroll bars it swept are updated again
+            int itr = task->cmd + 1;
+            int end = (int) list->size;
+            if(task->cmd >= 0)
+            {
+                end = cmds[task->cmd].childend;
+            }
+            while(itr != end)
+            {
+                taa_uilayout_cmd* cmd = cmds + itr;
+                int next = itr + 1;
+                if(cmd->control0 >= 0)
+                {
+                    taa_ui_control* control = controls + cmd->control0;
+                    if(control->type == taa_UI_VSCROLLBAR &&
+                       cmd->targetcmd >= 0)
+                    {
+                        taa_uilayout_scrollbar(
+                            cmds,
+                            cmd,
+                            styles,
+                            control,
+                            &cmd->contentrect);
+                    }
+                    if((control->flags & taa_UI_FLAG_CULLED) != 0)
+                    {
+                        // the descendants of a culled control were not
+                        // swept
+                        next = cmd->childend;
+                    }
+                }
+                itr = next;
+            }
+        }
+    }
+}
+
+//****************************************************************************
+static void taa_uilayout_pass1(
+    taa_uilayout_list* list,
+    const taa_ui_style* styles,
+    taa_ui_control* controls,
+    const taa_ui_rect* screenrect)
+{
+    taa_uilayout_task* sweep = &list->sweep;
+    taa_ui_rect emptyarea = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    if(sweep->frames == NULL)
+    {
+        sweep->numframes = 16;
+        sweep->frames = (taa_uilayout_frame*) malloc(
+            sweep->numframes * sizeof(*sweep->frames));
+    }
+    // the bottom frame holds the top level commands
+    sweep->cmd = -1;
+    sweep->frames[0].cmd = -1;
+    sweep->frames[0].end = (int) list->size;
+    sweep->frames[0].scrollx = 0;
+    sweep->frames[0].scrolly = 0;
+    sweep->frames[0].clip = *screenrect;
+    sweep->frames[0].childarea = emptyarea;
+    sweep->numpostponed = 0;
+    sweep->isoverflowed = 0;
+    list->numtasks = 0;
+    taa_uilayout_place(
+        list->cmds,
+        taa_UILAYOUT_ABS,
+        taa_UI_HALIGN_LEFT,
+        taa_UI_VALIGN_TOP,
+        0,
+        screenrect,
+        0,
+        (int) list->size);
+    taa_uilayout_sweep(list, sweep, styles, controls);
+    if(list->numtasks > 0)
+    {
+        // the subtrees handed to tasks are independent of each other and
+        // of the rest of the list, which has been swept
+        taa_uilayout_dispatch dispatch;
+        dispatch.list = list;
+        dispatch.styles = styles;
+        dispatch.controls = controls;
+        list->dispatchfunc(
+            list->dispatchdata,
+            taa_uilayout_run_task,
+            &dispatch,
+            (int) list->numtasks);
+        taa_uilayout_join(list, styles, controls);
     }
 }
 
@@ -763,6 +1728,8 @@ static int taa_uilayout_push(
         cmd->halign = halign;
         cmd->valign = valign;
         cmd->spacing = spacing;
+        // the spacing may be packed into 16 bits
+        assert(cmd->spacing == spacing);
         cmd->parentcmd = parent;
         cmd->targetcmd = targetcmd;
         cmd->childbegin = index + 1;
@@ -771,6 +1738,10 @@ static int taa_uilayout_push(
         cmd->control1 = -1;
         cmd->scrollx = scrollx;
         cmd->scrolly = scrolly;
+        cmd->virtualh = -1;
+        cmd->cellw = 0;
+        cmd->cellh = 0;
+        cmd->numcols = 0;
         cmd->rect = *rect;
         ++list->size;
     }
@@ -783,10 +1754,15 @@ static void taa_uilayout_pop(
     int cmdindex,
     int control)
 {
-    taa_uilayout_cmd* cmd = list->cmds + cmdindex;
-    assert(((size_t) cmdindex) < list->size);
-    cmd->control1 = control;
-    cmd->childend = list->size;
+    // a negative index means the push was discarded because the list was
+    // full, and there is nothing to pop
+    if(cmdindex >= 0)
+    {
+        taa_uilayout_cmd* cmd = list->cmds + cmdindex;
+        assert(((size_t) cmdindex) < list->size);
+        cmd->control1 = control;
+        cmd->childend = list->size;
+    }
 }
 
 //****************************************************************************
@@ -794,6 +1770,7 @@ static void taa_uilayout_begin(
     taa_uilayout_list* list)
 {
     list->size = 0;
+    list->iswrapping = 0;
 }
 
 //****************************************************************************
@@ -803,42 +1780,32 @@ static void taa_uilayout_end(
     taa_ui_control* controls,
     const taa_ui_rect* screenrect)
 {
-    taa_ui_rect uiarea;
     // fixed and auto layout sizes must be calculated before fill sizes. fill
     // sizes in column and row modes are affected by the amount of available
     // space after fixed space has been allocated. fixed and auto sized space
     // must be calculated from the bottom up, as auto sized containers will
     // depend on the size of their children
-    taa_uilayout_pass0(
-        list->cmds,
-        styles,
-        controls,
-        taa_UI_HALIGN_LEFT,
-        taa_UI_VALIGN_TOP,
-        0,
-        list->size);
+    taa_uilayout_pass0(list, styles, controls, screenrect);
     // fill sizes are calculated after all the fixed and auto sized space has
     // been calculated. fill space is calculated from the top down, as child
     // controls must fit the available space within their containers
-    uiarea.x = INT_MAX;
-    uiarea.y = INT_MAX;
-    uiarea.w = INT_MIN;
-    uiarea.h = INT_MIN;
-    taa_uilayout_pass1(
-        list->cmds,
-        styles,
-        controls,
-        taa_UILAYOUT_ABS,
-        taa_UI_HALIGN_LEFT,
-        taa_UI_VALIGN_TOP,
-        0,
-        0,
-        0,
-        screenrect,
-        screenrect,
-        &uiarea,
-        0,
-        list->size);
+    taa_uilayout_pass1(list, styles, controls, screenrect);
+}
+
+//****************************************************************************
+static void taa_uilayout_destroy(
+    taa_uilayout_list* list)
+{
+    size_t i;
+    for(i = 0; i < list->taskcapacity; ++i)
+    {
+        free(list->tasks[i].frames);
+        free(list->tasks[i].postponed);
+    }
+    free(list->tasks);
+    free(list->sweep.frames);
+    free(list->sweep.postponed);
+    taa_uiwrap_destroy(&list->wrap);
 }
 
 #endif // taa_UILAYOUT_H_
@@ -0,0 +1,371 @@
+/**
+ * @brief     ui point query index
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#ifndef taa_UIPICK_H_
+#define taa_UIPICK_H_
+
+#include <taa/ui.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+//****************************************************************************
+// enums
+
+enum
+{
+    /// maximum number of cells along each axis of the grid
+    taa_UIPICK_MAX_CELLS = 128,
+    /// number of queries of a frame answered by scanning the controls. with
+    /// 50k controls, building the grid costs about as much as eight scans
+    taa_UIPICK_MAX_SCANS = 8
+};
+
+//****************************************************************************
+// typedefs
+
+typedef struct taa_uipick_grid_s taa_uipick_grid;
+
+//****************************************************************************
+// structs
+
+// uniform grid over the view. each cell lists the controls whose clip rect
+// overlaps it, in the order of the control list, so that a point query
+// only tests the few controls of one cell, starting from the last one. the
+// grid is only built once a frame has been queried more than a few times,
+// and the first queries scan the whole control list instead
+struct taa_uipick_grid_s
+{
+    // controls of the frame the grid indexes
+    const taa_ui_control* controls;
+    size_t numcontrols;
+    int viewwidth;
+    int viewheight;
+    // offset of the first entry of each cell, plus one for the end
+    int* cells;
+    size_t cellcapacity;
+    int* entries;
+    size_t entrycapacity;
+    int numcols;
+    int numrows;
+    // the cells are a power of two in size, so that points are mapped to
+    // cells by shifts rather than divisions
+    int cellshiftx;
+    int cellshifty;
+    // number of queries of the frame answered by scanning the controls
+    int numscans;
+    // nonzero once the grid has been built for the controls
+    int isvalid;
+};
+
+//****************************************************************************
+// functions
+
+//****************************************************************************
+/**
+ * @brief tests whether a control may be found by a point query
+ */
+static int taa_uipick_is_pickable(
+    const taa_ui_control* ctrl)
+{
+    return
+        ctrl->type != taa_UI_CONTAINER_END &&
+        ctrl->type != taa_UI_LABEL &&
+        ctrl->type != taa_UI_PARAGRAPH &&
+        ctrl->cliprect.w > 0 &&
+        ctrl->cliprect.h > 0;
+}
+
+//****************************************************************************
+/**
+ * @brief finds the range of cells overlapped by a clip rect
+ * @return zero if the rect is outside of the grid
+ */
+static int taa_uipick_cell_range(
+    const taa_uipick_grid* grid,
+    const taa_ui_rect* r,
+    int* col0_out,
+    int* row0_out,
+    int* col1_out,
+    int* row1_out)
+{
+    int result = 0;
+    int xl = (r->x > 0) ? r->x : 0;
+    int yt = (r->y > 0) ? r->y : 0;
+    int xr = r->x + r->w;
+    int yb = r->y + r->h;
+    xr = (xr < grid->viewwidth) ? xr : grid->viewwidth;
+    yb = (yb < grid->viewheight) ? yb : grid->viewheight;
+    if(xl < xr && yt < yb)
+    {
+        *col0_out = xl >> grid->cellshiftx;
+        *row0_out = yt >> grid->cellshifty;
+        *col1_out = (xr - 1) >> grid->cellshiftx;
+        *row1_out = (yb - 1) >> grid->cellshifty;
+        result = 1;
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief builds the grid from the controls of the frame
+ * @details the controls are counted into the cells they overlap, and then
+ * stored in a second pass, so each cell is a contiguous run of entries.
+ * the number of cells grows with the number of visible controls, so that
+ * each cell holds a few of them.
+ */
+static void taa_uipick_build(
+    taa_uipick_grid* grid)
+{
+    const taa_ui_control* controls = grid->controls;
+    int numcontrols = (int) grid->numcontrols;
+    int vw = (grid->viewwidth > 0) ? grid->viewwidth : 1;
+    int vh = (grid->viewheight > 0) ? grid->viewheight : 1;
+    int numpickable = 0;
+    int shiftx = 0;
+    int shifty = 0;
+    int numcols;
+    int numrows;
+    int numcells;
+    int numentries;
+    int col0;
+    int row0;
+    int col1;
+    int row1;
+    int i;
+    for(i = 0; i < numcontrols; ++i)
+    {
+        numpickable += taa_uipick_is_pickable(controls + i);
+    }
+    // start with a single cell covering the view, and halve the longer
+    // side of the cells until they hold a couple of controls each
+    while((1 << shiftx) < vw)
+    {
+        ++shiftx;
+    }
+    while((1 << shifty) < vh)
+    {
+        ++shifty;
+    }
+    numcols = 1;
+    numrows = 1;
+    while(numcols*numrows*2 < numpickable)
+    {
+        // the number of cells along each axis if it were split
+        int splitcols = INT_MAX;
+        int splitrows = INT_MAX;
+        if(shiftx > 0)
+        {
+            splitcols = ((vw - 1) >> (shiftx - 1)) + 1;
+        }
+        if(shifty > 0)
+        {
+            splitrows = ((vh - 1) >> (shifty - 1)) + 1;
+        }
+        if(shiftx >= shifty && splitcols <= taa_UIPICK_MAX_CELLS)
+        {
+            --shiftx;
+            numcols = splitcols;
+        }
+        else if(splitrows <= taa_UIPICK_MAX_CELLS)
+        {
+            --shifty;
+            numrows = splitrows;
+        }
+        else if(splitcols <= taa_UIPICK_MAX_CELLS)
+        {
+            --shiftx;
+            numcols = splitcols;
+        }
+        else
+        {
+            break;
+        }
+    }
+    grid->numcols = numcols;
+    grid->numrows = numrows;
+    grid->cellshiftx = shiftx;
+    grid->cellshifty = shifty;
+    numcells = numcols * numrows;
+    if(((size_t) numcells + 1) > grid->cellcapacity)
+    {
+        grid->cellcapacity = numcells + 1;
+        grid->cells = (int*) realloc(
+            grid->cells,
+            grid->cellcapacity * sizeof(*grid->cells));
+    }
+    memset(grid->cells, 0, (numcells + 1) * sizeof(*grid->cells));
+    for(i = 0; i < numcontrols; ++i)
+    {
+        const taa_ui_control* ctrl = controls + i;
+        const taa_ui_rect* r = &ctrl->cliprect;
+        if(taa_uipick_is_pickable(ctrl) &&
+           taa_uipick_cell_range(grid, r, &col0, &row0, &col1, &row1))
+        {
+            int row;
+            for(row = row0; row <= row1; ++row)
+            {
+                int* cell = grid->cells + row*numcols + 1;
+                int col;
+                for(col = col0; col <= col1; ++col)
+                {
+                    ++cell[col];
+                }
+            }
+        }
+    }
+    for(i = 0; i < numcells; ++i)
+    {
+        grid->cells[i + 1] += grid->cells[i];
+    }
+    numentries = grid->cells[numcells];
+    if(((size_t) numentries) > grid->entrycapacity)
+    {
+        grid->entrycapacity = numentries;
+        grid->entries = (int*) realloc(
+            grid->entries,
+            grid->entrycapacity * sizeof(*grid->entries));
+    }
+    // the offset of each cell is advanced as its entries are stored, which
+    // leaves it at the start of the next cell, so the offsets are shifted
+    // up by one once all the entries are stored
+    for(i = 0; i < numcontrols; ++i)
+    {
+        const taa_ui_control* ctrl = controls + i;
+        const taa_ui_rect* r = &ctrl->cliprect;
+        if(taa_uipick_is_pickable(ctrl) &&
+           taa_uipick_cell_range(grid, r, &col0, &row0, &col1, &row1))
+        {
+            int row;
+            for(row = row0; row <= row1; ++row)
+            {
+                int* cell = grid->cells + row*numcols;
+                int col;
+                for(col = col0; col <= col1; ++col)
+                {
+                    grid->entries[cell[col]++] = i;
+                }
+            }
+        }
+    }
+    memmove(grid->cells + 1, grid->cells, numcells * sizeof(*grid->cells));
+    grid->cells[0] = 0;
+    grid->isvalid = 1;
+}
+
+//****************************************************************************
+/**
+ * @brief sets the controls of a new frame, which are indexed on first use
+ */
+static void taa_uipick_reset(
+    taa_uipick_grid* grid,
+    const taa_ui_control* controls,
+    size_t numcontrols,
+    int viewwidth,
+    int viewheight)
+{
+    grid->controls = controls;
+    grid->numcontrols = numcontrols;
+    grid->viewwidth = viewwidth;
+    grid->viewheight = viewheight;
+    grid->numscans = 0;
+    grid->isvalid = 0;
+}
+
+//****************************************************************************
+/**
+ * @brief finds the control under a point by testing every control of the
+ * frame, starting from the last one
+ * @return the index of the control, or -1 if there is none
+ */
+static int taa_uipick_scan(
+    const taa_uipick_grid* grid,
+    int x,
+    int y)
+{
+    int result = -1;
+    int i = (int) grid->numcontrols;
+    while(i > 0)
+    {
+        const taa_ui_control* ctrl;
+        const taa_ui_rect* r;
+        --i;
+        ctrl = grid->controls + i;
+        r = &ctrl->cliprect;
+        if(taa_uipick_is_pickable(ctrl) &&
+           r->x <= x && r->y <= y && r->x+r->w > x && r->y+r->h > y)
+        {
+            result = i;
+            break;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+/**
+ * @brief finds the last control in the list whose clip rect contains a
+ * point, which is the control drawn on top
+ * @details a single query is cheaper to answer by scanning the controls
+ * than by building the grid, so the grid is only built once the frame has
+ * been queried taa_UIPICK_MAX_SCANS times
+ * @return the index of the control, or -1 if there is none
+ */
+static int taa_uipick_find(
+    taa_uipick_grid* grid,
+    int x,
+    int y)
+{
+    int result = -1;
+    if(x >= 0 && y >= 0 && x < grid->viewwidth && y < grid->viewheight)
+    {
+        if(!grid->isvalid && grid->numscans < taa_UIPICK_MAX_SCANS)
+        {
+            ++grid->numscans;
+            result = taa_uipick_scan(grid, x, y);
+        }
+        else
+        {
+            int col;
+            int row;
+            const int* cell;
+            const int* begin;
+            const int* itr;
+            if(!grid->isvalid)
+            {
+                taa_uipick_build(grid);
+            }
+            col = x >> grid->cellshiftx;
+            row = y >> grid->cellshifty;
+            cell = grid->cells + row*grid->numcols + col;
+            begin = grid->entries + cell[0];
+            itr = grid->entries + cell[1];
+            while(itr != begin)
+            {
+                const taa_ui_rect* r;
+                --itr;
+                r = &grid->controls[*itr].cliprect;
+                if(r->x <= x && r->y <= y && r->x+r->w > x && r->y+r->h > y)
+                {
+                    result = *itr;
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+static void taa_uipick_destroy(
+    taa_uipick_grid* grid)
+{
+    free(grid->cells);
+    free(grid->entries);
+}
+
+#endif // taa_UIPICK_H_
@@ -0,0 +1,464 @@
+/**
+ * @brief     ui input recording and playback implementation
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#include <taa/uireplay.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+//****************************************************************************
+// enums
+
+enum
+{
+    taa_UIREPLAY_VERSION = 1,
+    // literal runs absorb runs of unchanged bytes shorter than this, so
+    // scattered changes do not produce many small runs
+    taa_UIREPLAY_MIN_SKIP = 3
+};
+
+enum
+{
+    // flags stored at the start of each frame for the parts that changed
+    taa_UIREPLAY_FRAME_VIEW = 1 << 0,
+    taa_UIREPLAY_FRAME_KEYBOARD = 1 << 1,
+    taa_UIREPLAY_FRAME_MOUSE = 1 << 2,
+    taa_UIREPLAY_FRAME_EVENTS = 1 << 3
+};
+
+//****************************************************************************
+// structs
+
+struct taa_ui_recorder_s
+{
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+    // state of the previous frame, which the next frame is encoded against
+    int vieww;
+    int viewh;
+    taa_keyboard_state kb;
+    taa_mouse_state mouse;
+};
+
+struct taa_ui_player_s
+{
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+    size_t firstframe;
+    int isvalid;
+    int vieww;
+    int viewh;
+    taa_keyboard_state kb;
+    taa_mouse_state mouse;
+    taa_window_event* events;
+    size_t eventcapacity;
+};
+
+static const char taa_uireplay_magic[4] = { 'T', 'U', 'I', 'R' };
+
+//****************************************************************************
+// functions
+
+//****************************************************************************
+static unsigned char* taa_uireplay_reserve(
+    taa_ui_recorder* recorder,
+    size_t size)
+{
+    if(recorder->size + size > recorder->capacity)
+    {
+        size_t capacity = recorder->capacity * 2;
+        size_t needed = recorder->size + size;
+        capacity = (capacity > 4096) ? capacity : 4096;
+        capacity = (capacity > needed) ? capacity : needed;
+        recorder->data = (unsigned char*) realloc(recorder->data, capacity);
+        recorder->capacity = capacity;
+    }
+    return recorder->data + recorder->size;
+}
+
+//****************************************************************************
+static void taa_uireplay_write(
+    taa_ui_recorder* recorder,
+    const void* data,
+    size_t size)
+{
+    unsigned char* dst = taa_uireplay_reserve(recorder, size);
+    memcpy(dst, data, size);
+    recorder->size += size;
+}
+
+//****************************************************************************
+static void taa_uireplay_write_uint(
+    taa_ui_recorder* recorder,
+    uint32_t value)
+{
+    // 7 bits per byte, with the high bit set on all but the last byte
+    unsigned char* dst = taa_uireplay_reserve(recorder, 5);
+    unsigned char* itr = dst;
+    while(value >= 0x80)
+    {
+        *itr = (unsigned char) (value | 0x80);
+        value >>= 7;
+        ++itr;
+    }
+    *itr = (unsigned char) value;
+    ++itr;
+    recorder->size += (size_t) (itr - dst);
+}
+
+//****************************************************************************
+static void taa_uireplay_write_delta(
+    taa_ui_recorder* recorder,
+    const void* cur,
+    void* prev,
+    size_t size)
+{
+    // stored as pairs of a count of unchanged bytes followed by a count of
+    // bytes xor'd with the previous frame, until the block is covered
+    const unsigned char* src = (const unsigned char*) cur;
+    unsigned char* dst = (unsigned char*) prev;
+    size_t i = 0;
+    while(i < size)
+    {
+        size_t skip = i;
+        size_t lit;
+        size_t j;
+        unsigned char* xordst;
+        while(skip < size && src[skip] == dst[skip])
+        {
+            ++skip;
+        }
+        lit = skip;
+        j = skip;
+        while(j < size)
+        {
+            if(src[j] != dst[j])
+            {
+                ++j;
+                lit = j;
+            }
+            else if(j - lit < taa_UIREPLAY_MIN_SKIP)
+            {
+                ++j;
+            }
+            else
+            {
+                break;
+            }
+        }
+        taa_uireplay_write_uint(recorder, (uint32_t) (skip - i));
+        taa_uireplay_write_uint(recorder, (uint32_t) (lit - skip));
+        xordst = taa_uireplay_reserve(recorder, lit - skip);
+        for(j = skip; j < lit; ++j)
+        {
+            xordst[j - skip] = (unsigned char) (src[j] ^ dst[j]);
+        }
+        recorder->size += lit - skip;
+        i = lit;
+    }
+    memcpy(prev, cur, size);
+}
+
+//****************************************************************************
+static int taa_uireplay_read(
+    taa_ui_player* player,
+    void* data,
+    size_t size)
+{
+    int result = 0;
+    if(player->size - player->offset >= size)
+    {
+        memcpy(data, player->data + player->offset, size);
+        player->offset += size;
+        result = 1;
+    }
+    return result;
+}
+
+//****************************************************************************
+static int taa_uireplay_read_uint(
+    taa_ui_player* player,
+    uint32_t* value_out)
+{
+    uint32_t value = 0;
+    int shift = 0;
+    int result = 0;
+    while(player->offset < player->size && shift < 35)
+    {
+        unsigned char b = player->data[player->offset];
+        ++player->offset;
+        value |= ((uint32_t) (b & 0x7f)) << shift;
+        shift += 7;
+        if((b & 0x80) == 0)
+        {
+            result = 1;
+            break;
+        }
+    }
+    *value_out = value;
+    return result;
+}
+
+//****************************************************************************
+static int taa_uireplay_read_delta(
+    taa_ui_player* player,
+    void* prev,
+    size_t size)
+{
+    unsigned char* dst = (unsigned char*) prev;
+    size_t i = 0;
+    int result = 1;
+    while(result && i < size)
+    {
+        uint32_t skip;
+        uint32_t lit;
+        result =
+            taa_uireplay_read_uint(player, &skip) &&
+            taa_uireplay_read_uint(player, &lit) &&
+            (skip > 0 || lit > 0) &&
+            skip <= size - i &&
+            lit <= size - i - skip &&
+            lit <= player->size - player->offset;
+        if(result)
+        {
+            const unsigned char* src = player->data + player->offset;
+            uint32_t j;
+            i += skip;
+            for(j = 0; j < lit; ++j)
+            {
+                dst[i + j] ^= src[j];
+            }
+            i += lit;
+            player->offset += lit;
+        }
+    }
+    return result;
+}
+
+//****************************************************************************
+void taa_ui_create_player(
+    const void* data,
+    size_t size,
+    taa_ui_player** player_out)
+{
+    taa_ui_player* player;
+    char magic[4];
+    uint32_t version;
+    uint32_t kbsize;
+    uint32_t mousesize;
+    uint32_t evtsize;
+    player = (taa_ui_player*) calloc(1, sizeof(*player));
+    player->data = (const unsigned char*) data;
+    player->size = size;
+    // the header identifies the stream and the layout of the structures
+    // stored in it
+    player->isvalid =
+        taa_uireplay_read(player, magic, sizeof(magic)) &&
+        !memcmp(magic, taa_uireplay_magic, sizeof(magic)) &&
+        taa_uireplay_read_uint(player, &version) &&
+        version == taa_UIREPLAY_VERSION &&
+        taa_uireplay_read_uint(player, &kbsize) &&
+        kbsize == sizeof(taa_keyboard_state) &&
+        taa_uireplay_read_uint(player, &mousesize) &&
+        mousesize == sizeof(taa_mouse_state) &&
+        taa_uireplay_read_uint(player, &evtsize) &&
+        evtsize == sizeof(taa_window_event);
+    player->firstframe = (player->isvalid) ? player->offset : 0;
+    taa_ui_rewind_player(player);
+    *player_out = player;
+}
+
+//****************************************************************************
+void taa_ui_create_recorder(
+    taa_ui_recorder** recorder_out)
+{
+    taa_ui_recorder* recorder;
+    recorder = (taa_ui_recorder*) calloc(1, sizeof(*recorder));
+    taa_uireplay_write(
+        recorder,
+        taa_uireplay_magic,
+        sizeof(taa_uireplay_magic));
+    taa_uireplay_write_uint(recorder, taa_UIREPLAY_VERSION);
+    taa_uireplay_write_uint(recorder, sizeof(taa_keyboard_state));
+    taa_uireplay_write_uint(recorder, sizeof(taa_mouse_state));
+    taa_uireplay_write_uint(recorder, sizeof(taa_window_event));
+    *recorder_out = recorder;
+}
+
+//****************************************************************************
+void taa_ui_destroy_player(
+    taa_ui_player* player)
+{
+    free(player->events);
+    free(player);
+}
+
+//****************************************************************************
+void taa_ui_destroy_recorder(
+    taa_ui_recorder* recorder)
+{
+    free(recorder->data);
+    free(recorder);
+}
+
+//****************************************************************************
+const void* taa_ui_get_recording(
+    const taa_ui_recorder* recorder,
+    size_t* size_out)
+{
+    *size_out = recorder->size;
+    return recorder->data;
+}
+
+//****************************************************************************
+int taa_ui_play_begin(
+    taa_ui_player* player,
+    taa_ui* ui)
+{
+    unsigned char flags = 0;
+    uint32_t numevents = 0;
+    int result = player->isvalid && taa_uireplay_read(player, &flags, 1);
+    if(result && (flags & taa_UIREPLAY_FRAME_VIEW) != 0)
+    {
+        uint32_t w = 0;
+        uint32_t h = 0;
+        result =
+            taa_uireplay_read_uint(player, &w) &&
+            taa_uireplay_read_uint(player, &h);
+        player->vieww = (int) w;
+        player->viewh = (int) h;
+    }
+    if(result && (flags & taa_UIREPLAY_FRAME_KEYBOARD) != 0)
+    {
+        result = taa_uireplay_read_delta(
+            player,
+            &player->kb,
+            sizeof(player->kb));
+    }
+    if(result && (flags & taa_UIREPLAY_FRAME_MOUSE) != 0)
+    {
+        result = taa_uireplay_read_delta(
+            player,
+            &player->mouse,
+            sizeof(player->mouse));
+    }
+    if(result && (flags & taa_UIREPLAY_FRAME_EVENTS) != 0)
+    {
+        result = taa_uireplay_read_uint(player, &numevents);
+        // the count is checked against the rest of the stream before it
+        // is used to size the array, so a damaged frame cannot request an
+        // arbitrarily large allocation
+        result = result && numevents <=
+            (player->size - player->offset) / sizeof(*player->events);
+        if(result && numevents > player->eventcapacity)
+        {
+            taa_window_event* events = (taa_window_event*) realloc(
+                player->events,
+                numevents * sizeof(*player->events));
+            if(events != NULL)
+            {
+                player->events = events;
+                player->eventcapacity = numevents;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+        result = result && taa_uireplay_read(
+            player,
+            player->events,
+            numevents * sizeof(*player->events));
+    }
+    if(result)
+    {
+        taa_ui_begin(
+            ui,
+            player->vieww,
+            player->viewh,
+            &player->kb,
+            &player->mouse,
+            player->events,
+            (int) numevents);
+    }
+    else
+    {
+        // stop at the end of the stream, or at the first damaged frame
+        player->isvalid = 0;
+    }
+    return result;
+}
+
+//****************************************************************************
+void taa_ui_record_frame(
+    taa_ui_recorder* recorder,
+    int vieww,
+    int viewh,
+    const taa_keyboard_state* kb,
+    const taa_mouse_state* mouse,
+    const taa_window_event* winevents,
+    int numevents)
+{
+    unsigned char flags = 0;
+    if(vieww != recorder->vieww || viewh != recorder->viewh)
+    {
+        flags |= taa_UIREPLAY_FRAME_VIEW;
+    }
+    if(memcmp(kb, &recorder->kb, sizeof(*kb)) != 0)
+    {
+        flags |= taa_UIREPLAY_FRAME_KEYBOARD;
+    }
+    if(memcmp(mouse, &recorder->mouse, sizeof(*mouse)) != 0)
+    {
+        flags |= taa_UIREPLAY_FRAME_MOUSE;
+    }
+    if(numevents > 0)
+    {
+        flags |= taa_UIREPLAY_FRAME_EVENTS;
+    }
+    taa_uireplay_write(recorder, &flags, 1);
+    if((flags & taa_UIREPLAY_FRAME_VIEW) != 0)
+    {
+        taa_uireplay_write_uint(recorder, (uint32_t) vieww);
+        taa_uireplay_write_uint(recorder, (uint32_t) viewh);
+        recorder->vieww = vieww;
+        recorder->viewh = viewh;
+    }
+    if((flags & taa_UIREPLAY_FRAME_KEYBOARD) != 0)
+    {
+        taa_uireplay_write_delta(recorder, kb, &recorder->kb, sizeof(*kb));
+    }
+    if((flags & taa_UIREPLAY_FRAME_MOUSE) != 0)
+    {
+        taa_uireplay_write_delta(
+            recorder,
+            mouse,
+            &recorder->mouse,
+            sizeof(*mouse));
+    }
+    if((flags & taa_UIREPLAY_FRAME_EVENTS) != 0)
+    {
+        taa_uireplay_write_uint(recorder, (uint32_t) numevents);
+        taa_uireplay_write(
+            recorder,
+            winevents,
+            numevents * sizeof(*winevents));
+    }
+}
+
+//****************************************************************************
+void taa_ui_rewind_player(
+    taa_ui_player* player)
+{
+    player->offset = player->firstframe;
+    player->isvalid = player->firstframe > 0;
+    player->vieww = 0;
+    player->viewh = 0;
+    memset(&player->kb, 0, sizeof(player->kb));
+    memset(&player->mouse, 0, sizeof(player->mouse));
+}
@@ -334,6 +334,67 @@ void taa_ui_draw_visual_border(
     }
 }
 
+//****************************************************************************
+void taa_ui_draw_visual_paragraph(
+    const taa_ui_style* style,
+    const taa_ui_visual* visual,
+    const taa_ui_rect* rect,
+    const taa_ui_rect* clip,
+    const char* text,
+    const taa_ui_textline* lines,
+    uint32_t numlines,
+    taa_ui_drawlist* drawlist)
+{
+    const taa_ui_font* font = style->font;
+    int32_t loffset = style->lborder + style->lpadding;
+    int32_t roffset = style->rborder + style->rpadding;
+    int32_t toffset = style->tborder + style->tpadding;
+    int32_t boffset = style->bborder + style->bpadding;
+    int32_t textx = rect->x + loffset;
+    int32_t texty = rect->y + toffset;
+    int32_t cw = rect->w - loffset - roffset;
+    int32_t ch = rect->h - toffset - boffset;
+    int32_t lineh = font->charheight;
+    if(cw > 0 && ch > 0 && lineh > 0)
+    {
+        // only the lines within both the content area and the clip rect
+        // are drawn, so a long paragraph that is mostly scrolled out of
+        // view costs no more than its visible lines
+        int32_t top = (clip->y > texty) ? clip->y : texty;
+        int32_t bottom = texty + ch;
+        uint32_t i;
+        uint32_t end;
+        if(clip->y + clip->h < bottom)
+        {
+            bottom = clip->y + clip->h;
+        }
+        i = (top > texty) ? (top - texty) / lineh : 0;
+        end = (bottom > texty) ? (bottom - texty + lineh - 1) / lineh : 0;
+        end = (end < numlines) ? end : numlines;
+        for(; i < end; ++i)
+        {
+            int32_t y = texty + ((int32_t) i)*lineh;
+            int32_t h = texty + ch - y;
+            taa_ui_add_drawlist_text(
+                drawlist,
+                font,
+                visual->fgcolor,
+                text + lines[i].begin,
+                lines[i].length,
+                lines[i].width,
+                textx,
+                y,
+                cw,
+                (h < lineh) ? h : lineh,
+                0,
+                0,
+                style->halign,
+                taa_UI_VALIGN_TOP,
+                clip);
+        }
+    }
+}
+
 //****************************************************************************
 void taa_ui_draw_visual_text(
     const taa_ui_style* style,
@@ -342,6 +403,7 @@ void taa_ui_draw_visual_text(
     const taa_ui_rect* clip,
     const char* text,
     uint32_t textlen,
+    int32_t textwidth,
     int32_t caret,
     uint32_t selectstart,
     uint32_t selectlength,
@@ -379,6 +441,7 @@ void taa_ui_draw_visual_text(
                 visual->fgcolor,
                 "|",
                 1,
+                caretw,
                 textx + caretx - scrollx,
                 texty,
                 caretw,
@@ -395,6 +458,7 @@ void taa_ui_draw_visual_text(
             visual->fgcolor,
             text,
             textlen,
+            textwidth,
             textx,
             texty,
             cw,
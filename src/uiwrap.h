@@ -0,0 +1,373 @@
+/**
+ * @brief     ui paragraph line break cache
+ * @author    Thomas Atwood (tatwood.net)
+ * @date      2011
+ * @copyright unlicense / public domain
+ ****************************************************************************/
+#ifndef taa_UIWRAP_H_
+#define taa_UIWRAP_H_
+
+#include "uihash.h"
+#include <taa/ui.h>
+#include <string.h>
+#include <stdlib.h>
+
+//****************************************************************************
+// enums
+
+enum
+{
+    /// number of layout frames an unused entry is kept before it is freed
+    taa_UIWRAP_MAX_AGE = 64
+};
+
+//****************************************************************************
+// typedefs
+
+typedef struct taa_uiwrap_entry_s taa_uiwrap_entry;
+typedef struct taa_uiwrap_cache_s taa_uiwrap_cache;
+
+//****************************************************************************
+// structs
+
+// the lines of a text broken at a width. a null font marks an empty entry
+struct taa_uiwrap_entry_s
+{
+    const taa_ui_font* font;
+    // copy of the text. it is compared when the hash matches, since two
+    // different texts of the same length may share a hash
+    char* text;
+    uint32_t texthash;
+    uint32_t textlength;
+    int32_t width;
+    taa_ui_textline* lines;
+    uint32_t numlines;
+    // width of the longest line
+    int32_t maxwidth;
+    // last layout frame the entry was used
+    uint32_t frame;
+};
+
+// open addressed table of line breaks, keyed by font, text and width.
+// entries are never moved out of the way when others are freed, so unused
+// entries are only freed when the whole table is rebuilt
+struct taa_uiwrap_cache_s
+{
+    taa_uiwrap_entry* entries;
+    size_t numentries;
+    size_t numused;
+    uint32_t frame;
+};
+
+//****************************************************************************
+// functions
+
+//****************************************************************************
+static uint32_t taa_uiwrap_hash_text(
+    const char* text,
+    uint32_t textlength)
+{
+    uint32_t h = taa_UIHASH_BASIS;
+    const unsigned char* t = (const unsigned char*) text;
+    const unsigned char* tend = t + textlength;
+    // paragraphs may be kilobytes long, so a word is mixed per step
+    while(tend - t >= 4)
+    {
+        uint32_t word;
+        memcpy(&word, t, sizeof(word));
+        h = (h ^ word) * taa_UIHASH_PRIME;
+        t += 4;
+    }
+    return taa_uihash_add(h, t, (size_t) (tend - t));
+}
+
+//****************************************************************************
+static size_t taa_uiwrap_slot(
+    const taa_uiwrap_cache* cache,
+    const taa_ui_font* font,
+    uint32_t texthash,
+    uint32_t textlength,
+    int32_t width)
+{
+    uint32_t h = texthash;
+    h = (h ^ (uint32_t) width) * taa_UIHASH_PRIME;
+    h = (h ^ textlength) * taa_UIHASH_PRIME;
+    h = (h ^ (uint32_t) (((uintptr_t) font) >> 4)) * taa_UIHASH_PRIME;
+    h ^= h >> 15;
+    return h & (cache->numentries - 1);
+}
+
+//****************************************************************************
+/**
+ * @brief adds a line to an entry, growing its array by powers of two
+ */
+static void taa_uiwrap_add_line(
+    taa_uiwrap_entry* entry,
+    uint32_t begin,
+    uint32_t length,
+    int32_t width)
+{
+    uint32_t n = entry->numlines;
+    taa_ui_textline* line;
+    if(n >= 8 && (n & (n - 1)) == 0)
+    {
+        entry->lines = (taa_ui_textline*) realloc(
+            entry->lines,
+            n * 2 * sizeof(*entry->lines));
+    }
+    else if(n == 0)
+    {
+        entry->lines = (taa_ui_textline*) malloc(8*sizeof(*entry->lines));
+    }
+    line = entry->lines + n;
+    line->begin = begin;
+    line->length = length;
+    line->width = width;
+    if(width > entry->maxwidth)
+    {
+        entry->maxwidth = width;
+    }
+    entry->numlines = n + 1;
+}
+
+//****************************************************************************
+/**
+ * @brief breaks a text into lines no wider than the entry width
+ * @details lines are broken greedily at the last space that fits, and the
+ * spaces at the break are dropped. a word that does not fit on a line by
+ * itself is broken between characters, but each line holds at least one
+ * character besides any leading spaces. a newline always ends a line.
+ * spaces at the end of a line do not count toward its width, so they never
+ * cause a break.
+ */
+static void taa_uiwrap_break(
+    taa_uiwrap_entry* entry,
+    const char* text)
+{
+    const taa_ui_font* font = entry->font;
+    uint32_t textlength = entry->textlength;
+    uint32_t begin = 0;     // first character of the line
+    uint32_t visend = 0;    // end of the line, excluding trailing spaces
+    uint32_t brk = 0;       // end of the line if it breaks at a space
+    uint32_t word = 0;      // first character of the word after the break
+    uint32_t i = 0;
+    int32_t w = 0;          // width from the start of the line to i
+    int32_t visw = 0;
+    int32_t brkw = 0;
+    int32_t wordw = 0;
+    int isbreakable = 0;
+    entry->numlines = 0;
+    entry->maxwidth = 0;
+    while(i != textlength)
+    {
+        unsigned char c = (unsigned char) text[i];
+        int32_t cw = font->characters[c].width;
+        if(c == '\n')
+        {
+            taa_uiwrap_add_line(entry, begin, visend - begin, visw);
+            begin = i + 1;
+            visend = begin;
+            w = 0;
+            visw = 0;
+            isbreakable = 0;
+            ++i;
+        }
+        else if(c == ' ')
+        {
+            if(i > begin && text[i-1] != ' ')
+            {
+                brk = i;
+                brkw = w;
+                isbreakable = 1;
+            }
+            w += cw;
+            ++i;
+        }
+        else
+        {
+            if(isbreakable && text[i-1] == ' ')
+            {
+                word = i;
+                wordw = w;
+            }
+            if(w + cw > entry->width && visend > begin)
+            {
+                if(isbreakable)
+                {
+                    // the line ends at the last space, and the next line
+                    // starts with the word that did not fit
+                    taa_uiwrap_add_line(entry, begin, brk - begin, brkw);
+                    begin = word;
+                    w -= wordw;
+                }
+                else
+                {
+                    taa_uiwrap_add_line(entry, begin, i - begin, w);
+                    begin = i;
+                    w = 0;
+                }
+                // the partial word carried over has no spaces
+                visend = i;
+                visw = w;
+                isbreakable = 0;
+                // the character is tested again against the new line
+            }
+            else
+            {
+                w += cw;
+                ++i;
+                visend = i;
+                visw = w;
+            }
+        }
+    }
+    if(textlength > 0)
+    {
+        taa_uiwrap_add_line(entry, begin, visend - begin, visw);
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief frees the entries that have not been used recently
+ * @details the table is rebuilt without them, growing it if it is still
+ * more than half full, so that no probe sequence passes over a freed slot
+ */
+static void taa_uiwrap_rebuild(
+    taa_uiwrap_cache* cache)
+{
+    taa_uiwrap_entry* srcitr = cache->entries;
+    taa_uiwrap_entry* srcend = srcitr + cache->numentries;
+    taa_uiwrap_entry* entries;
+    size_t numentries = (cache->numentries > 0) ? cache->numentries : 16;
+    size_t numused = 0;
+    taa_uiwrap_entry* itr;
+    for(itr = srcitr; itr != srcend; ++itr)
+    {
+        if(itr->font != NULL)
+        {
+            if(cache->frame - itr->frame < taa_UIWRAP_MAX_AGE)
+            {
+                ++numused;
+            }
+            else
+            {
+                free(itr->text);
+                free(itr->lines);
+                itr->font = NULL;
+            }
+        }
+    }
+    while(numused * 2 >= numentries)
+    {
+        numentries <<= 1;
+    }
+    entries = (taa_uiwrap_entry*) calloc(numentries, sizeof(*entries));
+    cache->entries = entries;
+    cache->numentries = numentries;
+    cache->numused = numused;
+    for(itr = srcitr; itr != srcend; ++itr)
+    {
+        if(itr->font != NULL)
+        {
+            size_t i = taa_uiwrap_slot(
+                cache,
+                itr->font,
+                itr->texthash,
+                itr->textlength,
+                itr->width);
+            while(entries[i].font != NULL)
+            {
+                i = (i + 1) & (numentries - 1);
+            }
+            entries[i] = *itr;
+        }
+    }
+    free(srcitr);
+}
+
+//****************************************************************************
+/**
+ * @brief begins a layout frame, occasionally freeing unused entries
+ */
+static void taa_uiwrap_begin(
+    taa_uiwrap_cache* cache)
+{
+    ++cache->frame;
+    if(cache->numentries == 0 || (cache->frame % taa_UIWRAP_MAX_AGE) == 0)
+    {
+        taa_uiwrap_rebuild(cache);
+    }
+}
+
+//****************************************************************************
+/**
+ * @brief finds the lines of a text broken at a width, breaking it if the
+ * cache does not already hold them
+ * @details the returned entry remains valid until the cache is rebuilt,
+ * which never frees entries used by the previous frame
+ */
+static const taa_uiwrap_entry* taa_uiwrap_find(
+    taa_uiwrap_cache* cache,
+    const taa_ui_font* font,
+    const char* text,
+    uint32_t textlength,
+    int32_t width)
+{
+    uint32_t texthash = taa_uiwrap_hash_text(text, textlength);
+    taa_uiwrap_entry* entry;
+    size_t i;
+    if((cache->numused + 1) * 2 > cache->numentries)
+    {
+        taa_uiwrap_rebuild(cache);
+    }
+    i = taa_uiwrap_slot(cache, font, texthash, textlength, width);
+    entry = cache->entries + i;
+    while(entry->font != NULL)
+    {
+        if(entry->font == font &&
+           entry->texthash == texthash &&
+           entry->textlength == textlength &&
+           entry->width == width &&
+           !memcmp(entry->text, text, textlength))
+        {
+            break;
+        }
+        i = (i + 1) & (cache->numentries - 1);
+        entry = cache->entries + i;
+    }
+    if(entry->font == NULL)
+    {
+        entry->font = font;
+        entry->text = (char*) malloc(textlength + 1);
+        memcpy(entry->text, text, textlength);
+        entry->texthash = texthash;
+        entry->textlength = textlength;
+        entry->width = width;
+        entry->lines = NULL;
+        taa_uiwrap_break(entry, entry->text);
+        ++cache->numused;
+    }
+    entry->frame = cache->frame;
+    return entry;
+}
+
+//****************************************************************************
+static void taa_uiwrap_destroy(
+    taa_uiwrap_cache* cache)
+{
+    taa_uiwrap_entry* itr = cache->entries;
+    taa_uiwrap_entry* end = itr + cache->numentries;
+    while(itr != end)
+    {
+        if(itr->font != NULL)
+        {
+            free(itr->text);
+            free(itr->lines);
+        }
+        ++itr;
+    }
+    free(cache->entries);
+}
+
+#endif // taa_UIWRAP_H_
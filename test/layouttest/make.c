@@ -0,0 +1,7 @@
+#include "src/main.c"
+
+#include "../../src/uifont.c"
+
+#include "../../../taasdk/src/gl.c"
+#include "../../../taasdk/src/log.c"
+#include "../../../taasdk/src/system.c"
@@ -0,0 +1,984 @@
+#if defined(_DEBUG) && defined(_MSC_FULL_VER)
+#include <crtdbg.h>
+#endif
+
+#include <taa/ui.h>
+#include "../../../src/uilayout.h"
+#include "../../vlisttest/src/fontarial18n.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// benchmark of the layout engine. layout command lists are built for trees
+// of about 100k nodes with different shapes, and the sweep based layout in
+// uilayout.h is timed against the recursive layout it replaced, which is
+// kept below as a reference. the results of both are compared to verify
+// that they match. a list of rows is then placed in a pane of the height
+// of the screen, to time layout with culling enabled. a grid of labels is
+// timed against the same cells built from rows of columns. finally a set of
+// large panels is laid out with each panel handed to a task. the tasks are
+// run in order on the calling thread, which checks that they produce the
+// same results without timing any parallelism.
+
+enum
+{
+    LAYOUTTEST_CONTAINER,
+    LAYOUTTEST_LABEL,
+    LAYOUTTEST_NUM_STYLES
+};
+
+enum
+{
+    LAYOUTTEST_MAX_CMDS = 160000,
+    LAYOUTTEST_NUM_ROWS = 10000,
+    LAYOUTTEST_NUM_RUNS = 20,
+    LAYOUTTEST_GRID_COLS = 12,
+    LAYOUTTEST_CELL_W = 100,
+    LAYOUTTEST_CELL_H = 32,
+    LAYOUTTEST_CELL_SPACING = 4,
+    LAYOUTTEST_NUM_PANELS = 8,
+    LAYOUTTEST_TASK_THRESHOLD = 4096
+};
+
+typedef struct layouttest_tree_s layouttest_tree;
+
+struct layouttest_tree_s
+{
+    const char* name;
+    taa_uilayout_list list;
+    taa_ui_control* controls;
+    int numcontrols;
+};
+
+//****************************************************************************
+static void layouttest_pass0(
+    taa_uilayout_cmd* cmds,
+    const taa_ui_style* styles,
+    taa_ui_control* controls,
+    taa_ui_halign halign,
+    taa_ui_valign valign,
+    int begin,
+    int end)
+{
+    // recursive bottom-up calculation of fixed sized control dimensions
+    int itr = begin;
+    while(itr != end)
+    {
+        taa_uilayout_cmd* cmd = cmds + itr;
+        int childbegin = cmd->childbegin;
+        int childend = cmd->childend;
+        // recursively process all children first
+        if(childbegin != childend)
+        {
+            layouttest_pass0(
+                cmds,
+                styles,
+                controls,
+                cmd->halign,
+                cmd->valign,
+                childbegin,
+                childend);
+        }
+        // after children have been sized, compute width of current control
+        switch(cmd->rect.w)
+        {
+        case taa_UI_WIDTH_AUTO:
+            cmd->autow = taa_uilayout_auto_width(cmds,cmd,styles,controls);
+            cmd->rect.w = cmd->autow;
+            break;
+        case taa_UI_WIDTH_DEFAULT:
+            if(cmd->control0 >= 0)
+            {
+                const taa_ui_control* control = controls + cmd->control0;
+                const taa_ui_style* style = styles + control->styleid;
+                cmd->rect.w = style->defaultw;
+            }
+            else
+            {
+                cmd->rect.w = 0;
+            }
+            cmd->autow = cmd->rect.w;
+            break;
+        case taa_UI_WIDTH_FILL:
+            cmd->autow = taa_uilayout_auto_width(cmds,cmd,styles,controls);
+            break;
+        default:
+            cmd->autow = cmd->rect.w;
+            break;
+        }
+        // compute height of control
+        switch(cmd->rect.h)
+        {
+        case taa_UI_HEIGHT_AUTO:
+            cmd->autoh = taa_uilayout_auto_height(cmds,cmd,styles,controls);
+            cmd->rect.h = cmd->autoh;
+            break;
+        case taa_UI_HEIGHT_DEFAULT:
+            if(cmd->control0 >= 0)
+            {
+                const taa_ui_control* control = controls + cmd->control0;
+                const taa_ui_style* style = styles + control->styleid;
+                cmd->rect.h = style->defaulth;
+            }
+            else
+            {
+                cmd->rect.h = 0;
+            }
+            cmd->autoh = cmd->rect.h;
+            break;
+        case taa_UI_HEIGHT_FILL:
+            cmd->autoh = taa_uilayout_auto_height(cmds,cmd,styles,controls);
+            break;
+        default:
+            cmd->autoh = cmd->rect.h;
+            break;
+        }
+        itr = childend;
+        assert((itr == end) || (cmds[itr].parentcmd == cmd->parentcmd));
+    }
+}
+
+//****************************************************************************
+static void layouttest_pass1(
+    taa_uilayout_cmd* cmds,
+    const taa_ui_style* styles,
+    taa_ui_control* controls,
+    taa_uilayout_mode mode,
+    taa_ui_halign halign,
+    taa_ui_valign valign,
+    int spacing,
+    int scrollx,
+    int scrolly,
+    const taa_ui_rect* parentrect,
+    const taa_ui_rect* parentclip,
+    taa_ui_rect* parentarea,
+    int begin,
+    int end)
+{
+    // recursive top-down calculation of filled control dimensions, screen
+    // space positions, and clip rectangles
+    int itr;
+    // calculate size and layout of all the controls at this level first
+    switch(mode)
+    {
+    case taa_UILAYOUT_ABS:
+        taa_uilayout_abs(cmds, halign, valign, parentrect, begin, end);
+        break;
+    case taa_UILAYOUT_COLS:
+        taa_uilayout_cols(cmds, valign, spacing, parentrect, begin, end);
+        break;
+    case taa_UILAYOUT_ROWS:
+        taa_uilayout_rows(cmds, halign, spacing, parentrect, begin, end);
+        break;
+    case taa_UILAYOUT_GRID:
+        taa_uilayout_grid(
+            cmds,
+            cmds + cmds[begin].parentcmd,
+            parentrect,
+            begin,
+            end);
+        break;
+    }
+    // export layout to controls and recurse into children
+    itr = begin;
+    while(itr != end)
+    {
+        taa_uilayout_cmd* cmd = cmds + itr;
+        int childbegin = cmd->childbegin;
+        int childend = cmd->childend;
+        taa_ui_rect cliprect;  // rect this command is clipped against
+        taa_ui_rect contentrect; // used for child positioning and clipping
+        taa_ui_rect contentclip; // rect to clip child commands against
+        taa_ui_rect childarea; // measures area occupied by children
+        // adjust for scroll
+        if(cmd->control0 >= 0)
+        {
+            taa_ui_control* control = controls + cmd->control0;
+            const taa_ui_style* style = styles + control->styleid;
+            contentrect = cmd->rect;
+            contentrect.x += style->lborder + style->lpadding;
+            contentrect.y += style->rborder + style->rpadding;
+            contentrect.w -= style->lborder + style->lpadding;
+            contentrect.w -= style->rborder + style->rpadding;
+            contentrect.h -= style->tborder + style->tpadding;
+            contentrect.h -= style->bborder + style->bpadding;
+            if(contentrect.w < 0)
+            {
+                contentrect.w = 0;
+            }
+            if(contentrect.h < 0)
+            {
+                contentrect.h = 0;
+            }
+            taa_uilayout_intersect(&cmd->rect, parentclip, &cliprect);
+            // export layout to control
+            control->rect = cmd->rect;
+            control->cliprect = cliprect;
+            if(control->type == taa_UI_VSCROLLBAR && cmd->targetcmd >= 0)
+            {
+                // if it's a vertical scrollbar, the slider rect and range
+                // need to be calculated
+                taa_uilayout_cmd* targetcmd = cmds + cmd->targetcmd;
+                const taa_ui_style* ss;
+                taa_ui_rect sliderrect;
+                int range; // maximum scroll value
+                int value; // current scroll value
+                int slidermax; // maximum height of slider
+                int slidermin; // minimum height of slider
+                int sliderh; // height of slider
+                int sliderrange; // amount that slider can move
+                ss = styles + control->data.scroll.sliderstyleid;
+                range = targetcmd->childrenh - targetcmd->contentrect.h;
+                slidermax = contentrect.h;
+                slidermin = ss->tborder+ss->tpadding+ss->bpadding+ss->bborder;
+                sliderh = (range>0) ? (slidermax*slidermax)/range : slidermax;
+                sliderh = (sliderh >= slidermin) ? sliderh : slidermin;
+                sliderh = (sliderh <= slidermax) ? sliderh : slidermax;
+                sliderrange = slidermax - sliderh;
+                sliderrect = contentrect;
+                sliderrect.h = sliderh;
+                value = control->data.scroll.value;
+                if(sliderh > 0 && sliderrange > 0 && range > slidermax)
+                {
+                    // if scrollable
+                    sliderrect.y += (value*sliderrange)/range;
+                }
+                control->data.scroll.range = range;
+                control->data.scroll.sliderrect = sliderrect;
+                control->data.scroll.sliderpane = contentrect;
+            }
+            if(cmd->control1 >= 0)
+            {
+                // if two controls are associated with this layout command,
+                // export the rectangles to the second control as well
+                control = controls + cmd->control1;
+                control->rect = cmd->rect;
+                control->cliprect = cliprect;
+            }
+        }
+        else
+        {
+            contentrect = cmd->rect;
+            taa_uilayout_intersect(&cmd->rect, parentclip, &cliprect);
+        }
+        // export content size to cmd
+        cmd->contentrect = contentrect;
+        // after current control is calculated, descend into children
+        childarea.x = INT_MAX;
+        childarea.y = INT_MAX;
+        childarea.w = INT_MIN;
+        childarea.h = INT_MIN;
+        if(childbegin != childend)
+        {
+            taa_uilayout_intersect(&contentrect, &cliprect, &contentclip);
+            contentrect.x -= scrollx;
+            contentrect.y -= scrolly;
+            layouttest_pass1(
+                cmds,
+                styles,
+                controls,
+                cmd->mode,
+                cmd->halign,
+                cmd->valign,
+                cmd->spacing,
+                cmd->scrollx,
+                cmd->scrolly,
+                &contentrect,
+                &contentclip,
+                &childarea,
+                childbegin,
+                childend);
+        }
+        cmd->childrenw = (childarea.w >= 0) ? childarea.w : 0;
+        cmd->childrenh = (childarea.h >= 0) ? childarea.h : 0;
+        if(cmd->virtualh >= 0)
+        {
+            cmd->childrenh = cmd->virtualh;
+        }
+        if(cmd->control0 >= 0)
+        {
+            // if a control command, propogate area to parent
+            taa_uilayout_union(parentarea, &cmd->rect, parentarea);
+        }
+        else
+        {
+            // if a pure layout command, propogate child area to parent
+            taa_uilayout_union(parentarea, &childarea, parentarea);
+        }
+        itr = childend;
+        assert((itr == end) || (cmds[itr].parentcmd == cmd->parentcmd));
+    }
+}
+
+
+//****************************************************************************
+static int layouttest_add_control(
+    layouttest_tree* tree,
+    taa_ui_type type,
+    taa_ui_styleid styleid)
+{
+    static const char txt[] = "item";
+    taa_ui_control* control = tree->controls + tree->numcontrols;
+    memset(control, 0, sizeof(*control));
+    control->type = type;
+    control->styleid = styleid;
+    control->id = tree->numcontrols + 1;
+    if(type == taa_UI_LABEL)
+    {
+        control->data.text.type = taa_UI_DATA_TEXT;
+        control->data.text.text = txt;
+        control->data.text.textlength = sizeof(txt) - 1;
+        control->data.text.textcapacity = sizeof(txt);
+        control->data.text.textwidth = -1;
+    }
+    else
+    {
+        control->data.id.type = taa_UI_DATA_ID;
+        control->data.id.id = control->id;
+    }
+    return tree->numcontrols++;
+}
+
+//****************************************************************************
+static void layouttest_label(
+    layouttest_tree* tree,
+    int parent)
+{
+    static const taa_ui_rect rect={0,0,taa_UI_WIDTH_FILL,taa_UI_HEIGHT_AUTO};
+    int control = layouttest_add_control(
+        tree,
+        taa_UI_LABEL,
+        LAYOUTTEST_LABEL);
+    int cmd = taa_uilayout_push(
+        &tree->list,
+        taa_UILAYOUT_ABS,
+        taa_UI_HALIGN_LEFT,
+        taa_UI_VALIGN_TOP,
+        0,
+        parent,
+        -1,
+        control,
+        0,
+        0,
+        &rect);
+    taa_uilayout_pop(&tree->list, cmd, -1);
+}
+
+//****************************************************************************
+static int layouttest_push_container(
+    layouttest_tree* tree,
+    int parent)
+{
+    // matches the commands generated by taa_ui_push_container: a control
+    // command holding a rows command for the children
+    static const taa_ui_rect rect={0,0,taa_UI_WIDTH_FILL,taa_UI_HEIGHT_AUTO};
+    int control = layouttest_add_control(
+        tree,
+        taa_UI_CONTAINER_BEGIN,
+        LAYOUTTEST_CONTAINER);
+    int cmd = taa_uilayout_push(
+        &tree->list,
+        taa_UILAYOUT_ABS,
+        taa_UI_HALIGN_LEFT,
+        taa_UI_VALIGN_TOP,
+        0,
+        parent,
+        -1,
+        control,
+        0,
+        0,
+        &rect);
+    taa_uilayout_push(
+        &tree->list,
+        taa_UILAYOUT_ROWS,
+        taa_UI_HALIGN_LEFT,
+        taa_UI_VALIGN_TOP,
+        1,
+        cmd,
+        -1,
+        -1,
+        0,
+        0,
+        &rect);
+    return cmd;
+}
+
+//****************************************************************************
+static void layouttest_pop_container(
+    layouttest_tree* tree,
+    int cmd)
+{
+    taa_uilayout_pop(&tree->list, cmd + 1, -1);
+    taa_uilayout_pop(&tree->list, cmd, -1);
+}
+
+//****************************************************************************
+static void layouttest_build_balanced(
+    layouttest_tree* tree,
+    int parent,
+    int fanout,
+    int depth)
+{
+    if(depth > 0)
+    {
+        int cmd = layouttest_push_container(tree, parent);
+        int i;
+        for(i = 0; i < fanout; ++i)
+        {
+            layouttest_build_balanced(tree, cmd + 1, fanout, depth - 1);
+        }
+        layouttest_pop_container(tree, cmd);
+    }
+    else
+    {
+        layouttest_label(tree, parent);
+    }
+}
+
+//****************************************************************************
+static void layouttest_build_chains(
+    layouttest_tree* tree,
+    int numchains,
+    int depth)
+{
+    // nested tree view nodes, each with a label followed by its children
+    int* stack = (int*) malloc(depth * sizeof(*stack));
+    int i;
+    for(i = 0; i < numchains; ++i)
+    {
+        int parent = -1;
+        int d;
+        for(d = 0; d < depth; ++d)
+        {
+            stack[d] = layouttest_push_container(tree, parent);
+            parent = stack[d] + 1;
+            layouttest_label(tree, parent);
+        }
+        while(d > 0)
+        {
+            --d;
+            layouttest_pop_container(tree, stack[d]);
+        }
+    }
+    free(stack);
+}
+
+//****************************************************************************
+static void layouttest_build_flat(
+    layouttest_tree* tree,
+    int numitems)
+{
+    int cmd = layouttest_push_container(tree, -1);
+    int i;
+    for(i = 0; i < numitems; ++i)
+    {
+        layouttest_label(tree, cmd + 1);
+    }
+    layouttest_pop_container(tree, cmd);
+}
+
+//****************************************************************************
+static void layouttest_build_rows(
+    layouttest_tree* tree,
+    int numrows)
+{
+    // each row is a container with a pair of labels
+    int cmd = layouttest_push_container(tree, -1);
+    int i;
+    for(i = 0; i < numrows; ++i)
+    {
+        int row = layouttest_push_container(tree, cmd + 1);
+        layouttest_label(tree, row + 1);
+        layouttest_label(tree, row + 1);
+        layouttest_pop_container(tree, row);
+    }
+    layouttest_pop_container(tree, cmd);
+}
+
+//****************************************************************************
+static void layouttest_build_panels(
+    layouttest_tree* tree,
+    int numpanels)
+{
+    int cmd = layouttest_push_container(tree, -1);
+    int i;
+    for(i = 0; i < numpanels; ++i)
+    {
+        layouttest_build_balanced(tree, cmd + 1, 10, 4);
+    }
+    layouttest_pop_container(tree, cmd);
+}
+
+//****************************************************************************
+static void layouttest_build_grid(
+    layouttest_tree* tree,
+    int numcells,
+    int isgrid)
+{
+    // a container holding a grid of labels. if isgrid is zero, the cells
+    // are built from rows of columns instead, with the same placement
+    static const taa_ui_rect rect={0,0,taa_UI_WIDTH_FILL,taa_UI_HEIGHT_AUTO};
+    static const taa_ui_rect cellrect =
+    {
+        0, 0, LAYOUTTEST_CELL_W, LAYOUTTEST_CELL_H
+    };
+    int cmd = layouttest_push_container(tree, -1);
+    int grid = taa_uilayout_push(
+        &tree->list,
+        isgrid ? taa_UILAYOUT_GRID : taa_UILAYOUT_ROWS,
+        taa_UI_HALIGN_LEFT,
+        taa_UI_VALIGN_TOP,
+        LAYOUTTEST_CELL_SPACING,
+        cmd + 1,
+        -1,
+        -1,
+        0,
+        0,
+        &rect);
+    int row = -1;
+    int i;
+    tree->list.cmds[grid].cellw = LAYOUTTEST_CELL_W;
+    tree->list.cmds[grid].cellh = LAYOUTTEST_CELL_H;
+    tree->list.cmds[grid].numcols = LAYOUTTEST_GRID_COLS;
+    for(i = 0; i < numcells; ++i)
+    {
+        if(isgrid)
+        {
+            layouttest_label(tree, grid);
+        }
+        else
+        {
+            int cell;
+            if((i % LAYOUTTEST_GRID_COLS) == 0)
+            {
+                taa_uilayout_pop(&tree->list, row, -1);
+                row = taa_uilayout_push(
+                    &tree->list,
+                    taa_UILAYOUT_COLS,
+                    taa_UI_HALIGN_LEFT,
+                    taa_UI_VALIGN_TOP,
+                    LAYOUTTEST_CELL_SPACING,
+                    grid,
+                    -1,
+                    -1,
+                    0,
+                    0,
+                    &rect);
+            }
+            cell = taa_uilayout_push(
+                &tree->list,
+                taa_UILAYOUT_ABS,
+                taa_UI_HALIGN_LEFT,
+                taa_UI_VALIGN_TOP,
+                0,
+                row,
+                -1,
+                -1,
+                0,
+                0,
+                &cellrect);
+            layouttest_label(tree, cell);
+            taa_uilayout_pop(&tree->list, cell, -1);
+        }
+    }
+    taa_uilayout_pop(&tree->list, row, -1);
+    taa_uilayout_pop(&tree->list, grid, -1);
+    layouttest_pop_container(tree, cmd);
+}
+
+//****************************************************************************
+static int layouttest_compare(
+    const taa_uilayout_cmd* cmds,
+    const taa_ui_control* controls,
+    const taa_uilayout_cmd* refcmds,
+    const taa_ui_control* refcontrols,
+    int numcmds,
+    int numcontrols)
+{
+    // compares the layout results of the commands, ignoring the fields
+    // used internally by the layout engine
+    int ismatch = 1;
+    int i;
+    for(i = 0; i < numcmds && ismatch; ++i)
+    {
+        const taa_uilayout_cmd* a = cmds + i;
+        const taa_uilayout_cmd* b = refcmds + i;
+        ismatch =
+            !memcmp(&a->rect, &b->rect, sizeof(a->rect)) &&
+            !memcmp(&a->contentrect, &b->contentrect, sizeof(a->rect)) &&
+            a->autow == b->autow &&
+            a->autoh == b->autoh &&
+            a->childrenw == b->childrenw &&
+            a->childrenh == b->childrenh;
+    }
+    if(ismatch)
+    {
+        size_t ctrlsize = numcontrols * sizeof(*controls);
+        ismatch = !memcmp(controls, refcontrols, ctrlsize);
+    }
+    return ismatch;
+}
+
+//****************************************************************************
+static void layouttest_init_tree(
+    layouttest_tree* tree,
+    const char* name)
+{
+    memset(tree, 0, sizeof(*tree));
+    tree->name = name;
+    tree->list.cmds = (taa_uilayout_cmd*) malloc(
+        LAYOUTTEST_MAX_CMDS * sizeof(*tree->list.cmds));
+    tree->list.capacity = LAYOUTTEST_MAX_CMDS;
+    taa_uilayout_begin(&tree->list);
+    tree->controls = (taa_ui_control*) malloc(
+        LAYOUTTEST_MAX_CMDS * sizeof(*tree->controls));
+}
+
+//****************************************************************************
+static void layouttest_destroy_tree(
+    layouttest_tree* tree)
+{
+    taa_uilayout_destroy(&tree->list);
+    free(tree->list.cmds);
+    free(tree->controls);
+}
+
+//****************************************************************************
+static void layouttest_init_stylesheet(
+    taa_ui_style* styles,
+    const taa_ui_font* font)
+{
+    taa_ui_style* style;
+    int i;
+    memset(styles, 0, LAYOUTTEST_NUM_STYLES * sizeof(*styles));
+    for(i = 0; i < LAYOUTTEST_NUM_STYLES; ++i)
+    {
+        style = styles + i;
+        style->font = font;
+        style->halign = taa_UI_HALIGN_LEFT;
+        style->valign = taa_UI_VALIGN_TOP;
+        style->defaultw = font->maxcharwidth * 8;
+        style->defaulth = font->charheight;
+    }
+    style = styles + LAYOUTTEST_CONTAINER;
+    style->lborder = style->tborder = style->rborder = style->bborder = 1;
+    style->lpadding = style->tpadding = style->rpadding = style->bpadding = 2;
+}
+
+//****************************************************************************
+static double layouttest_time(
+    layouttest_tree* tree,
+    const taa_ui_style* styles,
+    const taa_uilayout_cmd* srccmds,
+    const taa_ui_control* srccontrols,
+    int isrecursive)
+{
+    taa_ui_rect screenrect = { 0, 0, 1280, 720 };
+    taa_uilayout_cmd* cmds = tree->list.cmds;
+    taa_ui_control* controls = tree->controls;
+    int size = (int) tree->list.size;
+    clock_t total = 0;
+    int i;
+    for(i = 0; i < LAYOUTTEST_NUM_RUNS; ++i)
+    {
+        clock_t start;
+        // layout resolves the sizes of the commands in place, so each run
+        // starts from a copy of the list as it was built
+        memcpy(cmds, srccmds, size * sizeof(*cmds));
+        memcpy(controls, srccontrols, tree->numcontrols * sizeof(*controls));
+        start = clock();
+        if(isrecursive)
+        {
+            taa_ui_rect uiarea = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+            layouttest_pass0(
+                cmds,
+                styles,
+                controls,
+                taa_UI_HALIGN_LEFT,
+                taa_UI_VALIGN_TOP,
+                0,
+                size);
+            layouttest_pass1(
+                cmds,
+                styles,
+                controls,
+                taa_UILAYOUT_ABS,
+                taa_UI_HALIGN_LEFT,
+                taa_UI_VALIGN_TOP,
+                0,
+                0,
+                0,
+                &screenrect,
+                &screenrect,
+                &uiarea,
+                0,
+                size);
+        }
+        else
+        {
+            taa_uilayout_end(&tree->list, styles, controls, &screenrect);
+        }
+        total += clock() - start;
+    }
+    return (1000.0 * total) / (CLOCKS_PER_SEC * LAYOUTTEST_NUM_RUNS);
+}
+
+//****************************************************************************
+static void layouttest_run(
+    layouttest_tree* tree,
+    const taa_ui_style* styles)
+{
+    size_t cmdsize = tree->list.size * sizeof(*tree->list.cmds);
+    size_t ctrlsize = tree->numcontrols * sizeof(*tree->controls);
+    taa_uilayout_cmd* srccmds = (taa_uilayout_cmd*) malloc(cmdsize);
+    taa_ui_control* srccontrols = (taa_ui_control*) malloc(ctrlsize);
+    taa_uilayout_cmd* refcmds = (taa_uilayout_cmd*) malloc(cmdsize);
+    taa_ui_control* refcontrols = (taa_ui_control*) malloc(ctrlsize);
+    double recursivems;
+    double sweepms;
+    int ismatch;
+    memcpy(srccmds, tree->list.cmds, cmdsize);
+    memcpy(srccontrols, tree->controls, ctrlsize);
+    recursivems = layouttest_time(tree, styles, srccmds, srccontrols, 1);
+    memcpy(refcmds, tree->list.cmds, cmdsize);
+    memcpy(refcontrols, tree->controls, ctrlsize);
+    sweepms = layouttest_time(tree, styles, srccmds, srccontrols, 0);
+    ismatch =
+        !memcmp(refcmds, tree->list.cmds, cmdsize) &&
+        !memcmp(refcontrols, tree->controls, ctrlsize);
+    printf(
+        "%-10s %7lu cmds  recursive %8.3f ms  sweep %8.3f ms  %s\n",
+        tree->name,
+        (unsigned long) tree->list.size,
+        recursivems,
+        sweepms,
+        ismatch ? "match" : "MISMATCH");
+    free(srccmds);
+    free(srccontrols);
+    free(refcmds);
+    free(refcontrols);
+}
+
+//****************************************************************************
+static void layouttest_run_culled(
+    layouttest_tree* tree,
+    const taa_ui_style* styles)
+{
+    // lays out the rows in a pane with and without culling. the controls
+    // that are not culled must match, and the culled controls must not be
+    // visible without culling
+    taa_ui_rect screenrect = { 0, 0, 1280, 720 };
+    size_t cmdsize = tree->list.size * sizeof(*tree->list.cmds);
+    size_t ctrlsize = tree->numcontrols * sizeof(*tree->controls);
+    taa_uilayout_cmd* srccmds = (taa_uilayout_cmd*) malloc(cmdsize);
+    taa_ui_control* srccontrols = (taa_ui_control*) malloc(ctrlsize);
+    taa_ui_control* refcontrols = (taa_ui_control*) malloc(ctrlsize);
+    double fullms;
+    double culledms;
+    int numculled = 0;
+    int ismatch = 1;
+    int i;
+    // the outer container is the pane, with a fixed height
+    tree->list.cmds[0].rect.h = screenrect.h;
+    memcpy(srccmds, tree->list.cmds, cmdsize);
+    memcpy(srccontrols, tree->controls, ctrlsize);
+    fullms = layouttest_time(tree, styles, srccmds, srccontrols, 0);
+    memcpy(refcontrols, tree->controls, ctrlsize);
+    tree->list.isculling = 1;
+    culledms = layouttest_time(tree, styles, srccmds, srccontrols, 0);
+    for(i = 0; i < tree->numcontrols && ismatch; ++i)
+    {
+        const taa_ui_control* a = tree->controls + i;
+        const taa_ui_control* b = refcontrols + i;
+        if((a->flags & taa_UI_FLAG_CULLED) != 0)
+        {
+            ismatch = b->cliprect.w <= 0 || b->cliprect.h <= 0;
+            ++numculled;
+        }
+        else
+        {
+            ismatch =
+                !memcmp(&a->rect, &b->rect, sizeof(a->rect)) &&
+                !memcmp(&a->cliprect, &b->cliprect, sizeof(a->cliprect));
+        }
+    }
+    printf(
+        "%-10s %7lu cmds  full      %8.3f ms  culled %7.3f ms  %s\n",
+        tree->name,
+        (unsigned long) tree->list.size,
+        fullms,
+        culledms,
+        ismatch ? "match" : "MISMATCH");
+    printf("%-10s %7d controls culled\n", "", numculled);
+    free(srccmds);
+    free(srccontrols);
+    free(refcontrols);
+}
+
+//****************************************************************************
+static void layouttest_run_grid(
+    layouttest_tree* grid,
+    layouttest_tree* ref,
+    const taa_ui_style* styles)
+{
+    // the trees add the same controls, so their rects are compared. the
+    // clip rects of controls that are clipped away may differ, as they
+    // are clipped by different layout commands
+    size_t gridsize = grid->list.size * sizeof(*grid->list.cmds);
+    size_t refsize = ref->list.size * sizeof(*ref->list.cmds);
+    size_t ctrlsize = grid->numcontrols * sizeof(*grid->controls);
+    taa_uilayout_cmd* gridcmds = (taa_uilayout_cmd*) malloc(gridsize);
+    taa_uilayout_cmd* refcmds = (taa_uilayout_cmd*) malloc(refsize);
+    taa_ui_control* srccontrols = (taa_ui_control*) malloc(ctrlsize);
+    double gridms;
+    double refms;
+    int ismatch = (grid->numcontrols == ref->numcontrols);
+    int i;
+    memcpy(gridcmds, grid->list.cmds, gridsize);
+    memcpy(refcmds, ref->list.cmds, refsize);
+    memcpy(srccontrols, grid->controls, ctrlsize);
+    gridms = layouttest_time(grid, styles, gridcmds, srccontrols, 0);
+    refms = layouttest_time(ref, styles, refcmds, srccontrols, 0);
+    for(i = 0; i < grid->numcontrols && ismatch; ++i)
+    {
+        const taa_ui_rect* a = &grid->controls[i].cliprect;
+        const taa_ui_rect* b = &ref->controls[i].cliprect;
+        ismatch =
+            !memcmp(
+                &grid->controls[i].rect,
+                &ref->controls[i].rect,
+                sizeof(*a)) &&
+            (!memcmp(a, b, sizeof(*a)) ||
+             ((a->w <= 0 || a->h <= 0) && (b->w <= 0 || b->h <= 0)));
+    }
+    printf(
+        "%-10s %7lu cmds  rows/cols %8.3f ms  grid %9.3f ms  %s\n",
+        grid->name,
+        (unsigned long) grid->list.size,
+        refms,
+        gridms,
+        ismatch ? "match" : "MISMATCH");
+    free(gridcmds);
+    free(refcmds);
+    free(srccontrols);
+}
+
+//****************************************************************************
+static void layouttest_dispatch(
+    void* userdata,
+    taa_ui_taskfunc task,
+    void* args,
+    int count)
+{
+    int* numtasks = (int*) userdata;
+    int i;
+    for(i = 0; i < count; ++i)
+    {
+        task(args, i);
+    }
+    *numtasks = count;
+}
+
+//****************************************************************************
+static void layouttest_run_dispatched(
+    layouttest_tree* tree,
+    const taa_ui_style* styles)
+{
+    size_t cmdsize = tree->list.size * sizeof(*tree->list.cmds);
+    size_t ctrlsize = tree->numcontrols * sizeof(*tree->controls);
+    taa_uilayout_cmd* srccmds = (taa_uilayout_cmd*) malloc(cmdsize);
+    taa_ui_control* srccontrols = (taa_ui_control*) malloc(ctrlsize);
+    taa_uilayout_cmd* refcmds = (taa_uilayout_cmd*) malloc(cmdsize);
+    taa_ui_control* refcontrols = (taa_ui_control*) malloc(ctrlsize);
+    double fullms;
+    double taskms;
+    int numtasks = 0;
+    int ismatch;
+    memcpy(srccmds, tree->list.cmds, cmdsize);
+    memcpy(srccontrols, tree->controls, ctrlsize);
+    fullms = layouttest_time(tree, styles, srccmds, srccontrols, 0);
+    memcpy(refcmds, tree->list.cmds, cmdsize);
+    memcpy(refcontrols, tree->controls, ctrlsize);
+    tree->list.dispatchfunc = layouttest_dispatch;
+    tree->list.dispatchdata = &numtasks;
+    tree->list.dispatchthreshold = LAYOUTTEST_TASK_THRESHOLD;
+    taskms = layouttest_time(tree, styles, srccmds, srccontrols, 0);
+    ismatch = layouttest_compare(
+        tree->list.cmds,
+        tree->controls,
+        refcmds,
+        refcontrols,
+        (int) tree->list.size,
+        tree->numcontrols);
+    printf(
+        "%-10s %7lu cmds  full      %8.3f ms  tasks %8.3f ms  %s\n",
+        tree->name,
+        (unsigned long) tree->list.size,
+        fullms,
+        taskms,
+        ismatch ? "match" : "MISMATCH");
+    printf("%-10s %7d tasks\n", "", numtasks);
+    free(srccmds);
+    free(srccontrols);
+    free(refcmds);
+    free(refcontrols);
+}
+
+//****************************************************************************
+int main(int argc, char* argv[])
+{
+    taa_ui_font font;
+    taa_ui_style styles[LAYOUTTEST_NUM_STYLES];
+    layouttest_tree tree;
+    layouttest_tree ref;
+
+#if defined(_DEBUG) && defined(_MSC_FULL_VER)
+    _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF|_CRTDBG_LEAK_CHECK_DF);
+#endif
+
+    // only the metrics of the font are needed without a renderer
+    memset(&font, 0, sizeof(font));
+    memcpy(&font, g_fontarial18n, offsetof(taa_ui_font, texture));
+    layouttest_init_stylesheet(styles, &font);
+    // the commands are smaller if built with taa_UI_PACK_LAYOUT_FIELDS
+    printf(
+        "%lu bytes per command\n",
+        (unsigned long) sizeof(*tree.list.cmds));
+
+    layouttest_init_tree(&tree, "flat");
+    layouttest_build_flat(&tree, 100000);
+    layouttest_run(&tree, styles);
+    layouttest_destroy_tree(&tree);
+
+    layouttest_init_tree(&tree, "balanced");
+    layouttest_build_balanced(&tree, -1, 10, 5);
+    layouttest_run(&tree, styles);
+    layouttest_destroy_tree(&tree);
+
+    layouttest_init_tree(&tree, "deep");
+    layouttest_build_chains(&tree, 33, 1000);
+    layouttest_run(&tree, styles);
+    layouttest_destroy_tree(&tree);
+
+    layouttest_init_tree(&tree, "pane");
+    layouttest_build_rows(&tree, LAYOUTTEST_NUM_ROWS);
+    layouttest_run_culled(&tree, styles);
+    layouttest_destroy_tree(&tree);
+
+    layouttest_init_tree(&tree, "grid");
+    layouttest_build_grid(&tree, LAYOUTTEST_NUM_ROWS, 1);
+    layouttest_init_tree(&ref, "reference");
+    layouttest_build_grid(&ref, LAYOUTTEST_NUM_ROWS, 0);
+    layouttest_run_grid(&tree, &ref, styles);
+    layouttest_destroy_tree(&tree);
+    layouttest_destroy_tree(&ref);
+
+    layouttest_init_tree(&tree, "panels");
+    layouttest_build_panels(&tree, LAYOUTTEST_NUM_PANELS);
+    layouttest_run_dispatched(&tree, styles);
+    layouttest_destroy_tree(&tree);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,9 @@
+#include "src/main.c"
+
+#include "../../src/uifont.c"
+#include "../../src/ui.c"
+#include "../../src/uireplay.c"
+
+#include "../../../taasdk/src/gl.c"
+#include "../../../taasdk/src/log.c"
+#include "../../../taasdk/src/system.c"
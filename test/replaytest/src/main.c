@@ -0,0 +1,446 @@
+#if defined(_DEBUG) && defined(_MSC_FULL_VER)
+#include <crtdbg.h>
+#endif
+
+#include <taa/ui.h>
+#include <taa/uireplay.h>
+#include "../../vlisttest/src/fontarial18n.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// headless driver for the ui simulation. "record" runs a scripted session
+// through a test scene and writes the input to a file. "play" feeds the
+// recorded input back through the same scene as fast as possible, and
+// prints the frame rate and a checksum of every control list, so runs can
+// be compared for both speed and determinism.
+
+enum
+{
+    REPLAYTEST_BUTTON,
+    REPLAYTEST_LABEL,
+    REPLAYTEST_LISTROW0,
+    REPLAYTEST_LISTROW1,
+    REPLAYTEST_SCROLLBAR,
+    REPLAYTEST_SCROLLPANE,
+    REPLAYTEST_TEXTBOX,
+    REPLAYTEST_WINDOW,
+    REPLAYTEST_NUM_STYLES
+};
+
+enum
+{
+    REPLAYTEST_MAX_EVENTS = 4,
+    REPLAYTEST_DEFAULT_FRAMES = 10000
+};
+
+typedef struct replaytest_scene_s replaytest_scene;
+
+struct replaytest_scene_s
+{
+    taa_ui_list list;
+    char txt[32];
+    int vscroll;
+};
+
+//****************************************************************************
+static void replaytest_init_stylesheet(
+    taa_ui_style* styles,
+    const taa_ui_font* font)
+{
+    taa_ui_style dflt;
+    int i;
+    dflt.font = font;
+    dflt.halign = taa_UI_HALIGN_LEFT;
+    dflt.valign = taa_UI_VALIGN_TOP;
+    dflt.lborder = 1;
+    dflt.tborder = 1;
+    dflt.rborder = 1;
+    dflt.bborder = 1;
+    dflt.lpadding = 2;
+    dflt.tpadding = 2;
+    dflt.rpadding = 2;
+    dflt.bpadding = 2;
+    dflt.defaultw = 6;
+    dflt.defaulth = font->charheight + 6;
+    for(i = 0; i < REPLAYTEST_NUM_STYLES; ++i)
+    {
+        styles[i] = dflt;
+    }
+    styles[REPLAYTEST_BUTTON].halign = taa_UI_HALIGN_CENTER;
+    styles[REPLAYTEST_BUTTON].valign = taa_UI_VALIGN_CENTER;
+    styles[REPLAYTEST_BUTTON].defaultw = font->maxcharwidth*6 + 6;
+    styles[REPLAYTEST_LABEL].lborder = 0;
+    styles[REPLAYTEST_LABEL].tborder = 0;
+    styles[REPLAYTEST_LABEL].rborder = 0;
+    styles[REPLAYTEST_LABEL].bborder = 0;
+    styles[REPLAYTEST_SCROLLBAR].defaultw = 16;
+    styles[REPLAYTEST_SCROLLPANE].defaultw = 16;
+    styles[REPLAYTEST_TEXTBOX].defaultw = font->maxcharwidth*16 + 6;
+}
+
+//****************************************************************************
+static void replaytest_build(
+    taa_ui* ui,
+    replaytest_scene* scene)
+{
+    static taa_ui_rect fillrect={0,0,taa_UI_WIDTH_FILL,taa_UI_HEIGHT_FILL};
+    static taa_ui_rect fillwrect={0,0,taa_UI_WIDTH_FILL,taa_UI_HEIGHT_AUTO};
+    static taa_ui_rect scrlrect={0,0,taa_UI_WIDTH_DEFAULT,taa_UI_HEIGHT_FILL};
+    taa_ui_rect rowrect = { 0, 0, taa_UI_WIDTH_FILL, 0 };
+    taa_ui_handle scrollhandle;
+    int begin;
+    int end;
+    int i;
+    rowrect.h = scene->list.itemheight;
+    taa_ui_push_rect(ui,taa_UI_HALIGN_CENTER,taa_UI_VALIGN_CENTER,&fillrect);
+    taa_ui_push_container(ui, REPLAYTEST_WINDOW, 0, &fillrect, 0, 0, -1);
+    taa_ui_push_rows(ui, taa_UI_HALIGN_LEFT, 3, &fillrect);
+    taa_ui_textbox(
+        ui,
+        REPLAYTEST_TEXTBOX,
+        0,
+        &fillwrect,
+        scene->txt,
+        sizeof(scene->txt),
+        NULL);
+    taa_ui_push_cols(ui, taa_UI_VALIGN_TOP, 2, &fillrect);
+    taa_ui_push_list(
+        ui,
+        REPLAYTEST_SCROLLPANE,
+        0,
+        &fillrect,
+        scene->vscroll,
+        -1,
+        &scene->list,
+        &begin,
+        &end);
+    for(i = begin; i < end; ++i)
+    {
+        if(taa_ui_memo_begin(ui, i, i))
+        {
+            char lbl[24];
+            sprintf(lbl, "row %d", i);
+            taa_ui_push_container(
+                ui,
+                REPLAYTEST_LISTROW0 + (i & 1),
+                0,
+                &rowrect,
+                0,
+                0,
+                i);
+            taa_ui_label(ui, REPLAYTEST_LABEL, &fillrect, lbl);
+            taa_ui_pop_container(ui, NULL, NULL, NULL);
+        }
+        taa_ui_memo_end(ui);
+    }
+    scrollhandle = taa_ui_pop_list(ui, &scene->vscroll, NULL);
+    taa_ui_vscrollbar(
+        ui,
+        REPLAYTEST_SCROLLPANE,
+        REPLAYTEST_SCROLLBAR,
+        0,
+        &scrlrect,
+        scrollhandle,
+        &scene->vscroll,
+        NULL);
+    taa_ui_pop_cols(ui);
+    taa_ui_push_rect(ui,taa_UI_HALIGN_RIGHT,taa_UI_VALIGN_TOP,&fillwrect);
+    {
+        taa_ui_rect dfltrect={0,0,taa_UI_WIDTH_DEFAULT,taa_UI_HEIGHT_DEFAULT};
+        taa_ui_button(ui, REPLAYTEST_BUTTON, 0, &dfltrect, "Ok", NULL);
+    }
+    taa_ui_pop_rect(ui);
+    taa_ui_pop_rows(ui);
+    taa_ui_pop_container(ui, NULL, NULL, NULL);
+    taa_ui_pop_rect(ui);
+}
+
+//****************************************************************************
+static void replaytest_init_scene(
+    replaytest_scene* scene,
+    taa_ui_style* styles)
+{
+    memset(scene, 0, sizeof(*scene));
+    scene->list.numitems = 100000;
+    scene->list.itemheight = styles[REPLAYTEST_LABEL].defaulth;
+    scene->list.contenth = -1;
+}
+
+//****************************************************************************
+static uint32_t replaytest_hash_controls(
+    uint32_t h,
+    const taa_ui_controllist* cl)
+{
+    const taa_ui_control* ctrlitr = cl->controls;
+    const taa_ui_control* ctrlend = ctrlitr + cl->numcontrols;
+    while(ctrlitr != ctrlend)
+    {
+        int32_t v[6];
+        const unsigned char* b = (const unsigned char*) v;
+        const unsigned char* bend = b + sizeof(v);
+        v[0] = ctrlitr->type;
+        v[1] = ctrlitr->flags;
+        v[2] = ctrlitr->rect.x;
+        v[3] = ctrlitr->rect.y;
+        v[4] = ctrlitr->rect.w;
+        v[5] = ctrlitr->rect.h;
+        while(b != bend)
+        {
+            h = (h ^ *b) * 16777619u;
+            ++b;
+        }
+        ++ctrlitr;
+    }
+    return (h ^ cl->caret) * 16777619u;
+}
+
+//****************************************************************************
+static unsigned int replaytest_rand(
+    unsigned int* seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 16) & 0x7fff;
+}
+
+//****************************************************************************
+static int replaytest_gen_input(
+    int frame,
+    unsigned int* seed,
+    int* vieww,
+    int* viewh,
+    taa_keyboard_state* kb,
+    taa_mouse_state* mouse,
+    taa_window_event* events)
+{
+    // a scripted session: the cursor wanders, clicks, types into whatever
+    // has focus, tabs between controls and resizes the view
+    int numevents = 0;
+    memset(events, 0, REPLAYTEST_MAX_EVENTS * sizeof(*events));
+    memset(kb->keys, 0, sizeof(kb->keys));
+    mouse->cursorx += ((int) replaytest_rand(seed) % 9) - 4;
+    mouse->cursory += ((int) replaytest_rand(seed) % 9) - 4;
+    mouse->cursorx = (mouse->cursorx < 0) ? 0 : mouse->cursorx;
+    mouse->cursory = (mouse->cursory < 0) ? 0 : mouse->cursory;
+    mouse->cursorx = (mouse->cursorx >= *vieww) ? *vieww-1 : mouse->cursorx;
+    mouse->cursory = (mouse->cursory >= *viewh) ? *viewh-1 : mouse->cursory;
+    if((frame % 97) == 0)
+    {
+        events[numevents].mouse.type = taa_WINDOW_EVENT_MOUSE_BUTTON1_DOWN;
+        events[numevents].mouse.cursorx = mouse->cursorx;
+        events[numevents].mouse.cursory = mouse->cursory;
+        mouse->button1 = 1;
+        ++numevents;
+    }
+    else if((frame % 97) == 20)
+    {
+        events[numevents].mouse.type = taa_WINDOW_EVENT_MOUSE_BUTTON1_UP;
+        events[numevents].mouse.cursorx = mouse->cursorx;
+        events[numevents].mouse.cursory = mouse->cursory;
+        mouse->button1 = 0;
+        ++numevents;
+    }
+    if((frame % 13) == 0)
+    {
+        char c = (char) ('a' + replaytest_rand(seed) % 26);
+        events[numevents].key.type = taa_WINDOW_EVENT_KEY_DOWN;
+        events[numevents].key.keycode = (taa_keyboard_keycode) c;
+        events[numevents].key.ascii = c;
+        kb->keys[(unsigned char) c] = 1;
+        ++numevents;
+    }
+    if((frame % 151) == 0)
+    {
+        events[numevents].key.type = taa_WINDOW_EVENT_KEY_DOWN;
+        events[numevents].key.keycode = taa_KEY_TAB;
+        kb->keys[taa_KEY_TAB] = 1;
+        ++numevents;
+    }
+    if((frame % 1009) == 0)
+    {
+        *vieww = 640 + (int) (replaytest_rand(seed) % 640);
+        *viewh = 360 + (int) (replaytest_rand(seed) % 360);
+        events[numevents].size.type = taa_WINDOW_EVENT_SIZE;
+        events[numevents].size.width = *vieww;
+        events[numevents].size.height = *viewh;
+        ++numevents;
+    }
+    return numevents;
+}
+
+//****************************************************************************
+static int replaytest_record(
+    const char* path,
+    int numframes,
+    taa_ui_style* styles)
+{
+    taa_ui* ui;
+    taa_ui_recorder* recorder;
+    replaytest_scene scene;
+    taa_keyboard_state kb;
+    taa_mouse_state mouse;
+    taa_window_event events[REPLAYTEST_MAX_EVENTS];
+    const void* data;
+    size_t size;
+    unsigned int seed = 1;
+    uint32_t h = 2166136261u;
+    int vieww = 1280;
+    int viewh = 720;
+    int err = 0;
+    int i;
+    FILE* fp;
+    taa_ui_create(64, 1024, 16*1024, styles, REPLAYTEST_NUM_STYLES, &ui);
+    taa_ui_create_recorder(&recorder);
+    replaytest_init_scene(&scene, styles);
+    memset(&kb, 0, sizeof(kb));
+    memset(&mouse, 0, sizeof(mouse));
+    mouse.cursorx = vieww / 2;
+    mouse.cursory = viewh / 2;
+    for(i = 0; i < numframes; ++i)
+    {
+        int numevents = replaytest_gen_input(
+            i,
+            &seed,
+            &vieww,
+            &viewh,
+            &kb,
+            &mouse,
+            events);
+        taa_ui_record_frame(
+            recorder,
+            vieww,
+            viewh,
+            &kb,
+            &mouse,
+            events,
+            numevents);
+        taa_ui_begin(ui, vieww, viewh, &kb, &mouse, events, numevents);
+        replaytest_build(ui, &scene);
+        h = replaytest_hash_controls(h, taa_ui_end(ui));
+    }
+    data = taa_ui_get_recording(recorder, &size);
+    fp = fopen(path, "wb");
+    err = (fp != NULL) ? 0 : -1;
+    if(err == 0)
+    {
+        err = (fwrite(data, 1, size, fp) == size) ? 0 : -1;
+        fclose(fp);
+    }
+    if(err == 0)
+    {
+        printf("recorded %d frames, ", numframes);
+        printf("%lu bytes\n", (unsigned long) size);
+        printf("checksum %08x\n", h);
+    }
+    else
+    {
+        printf("could not write %s\n", path);
+    }
+    taa_ui_destroy_recorder(recorder);
+    taa_ui_destroy(ui);
+    return err;
+}
+
+//****************************************************************************
+static int replaytest_play(
+    const char* path,
+    int numloops,
+    taa_ui_style* styles)
+{
+    taa_ui* ui;
+    taa_ui_player* player;
+    replaytest_scene scene;
+    void* data = NULL;
+    long size = 0;
+    uint32_t h = 0;
+    int numframes = 0;
+    int err = 0;
+    int i;
+    FILE* fp;
+    fp = fopen(path, "rb");
+    err = (fp != NULL) ? 0 : -1;
+    if(err == 0)
+    {
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        data = malloc(size);
+        err = (fread(data, 1, size, fp) == (size_t) size) ? 0 : -1;
+        fclose(fp);
+    }
+    if(err == 0)
+    {
+        clock_t start;
+        double secs;
+        taa_ui_create(64, 1024, 16*1024, styles, REPLAYTEST_NUM_STYLES, &ui);
+        taa_ui_create_player(data, size, &player);
+        start = clock();
+        for(i = 0; i < numloops; ++i)
+        {
+            // each loop starts from a fresh context and scene, so every
+            // loop produces the same checksum as the recording
+            taa_ui_destroy(ui);
+            taa_ui_create(64,1024,16*1024,styles,REPLAYTEST_NUM_STYLES,&ui);
+            replaytest_init_scene(&scene, styles);
+            taa_ui_rewind_player(player);
+            h = 2166136261u;
+            while(taa_ui_play_begin(player, ui))
+            {
+                replaytest_build(ui, &scene);
+                h = replaytest_hash_controls(h, taa_ui_end(ui));
+                ++numframes;
+            }
+        }
+        secs = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+        printf("played %d frames in %.3f s", numframes, secs);
+        if(secs > 0.0)
+        {
+            printf(", %.0f frames/s", numframes / secs);
+        }
+        printf("\nchecksum %08x\n", h);
+        taa_ui_destroy_player(player);
+        taa_ui_destroy(ui);
+    }
+    else
+    {
+        printf("could not read %s\n", path);
+    }
+    free(data);
+    return err;
+}
+
+//****************************************************************************
+int main(int argc, char* argv[])
+{
+    taa_ui_font font;
+    taa_ui_style styles[REPLAYTEST_NUM_STYLES];
+    int err = 0;
+
+#if defined(_DEBUG) && defined(_MSC_FULL_VER)
+    _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF|_CRTDBG_LEAK_CHECK_DF);
+#endif
+
+    // only the metrics of the font are needed without a renderer
+    memset(&font, 0, sizeof(font));
+    memcpy(&font, g_fontarial18n, offsetof(taa_ui_font, texture));
+    replaytest_init_stylesheet(styles, &font);
+    if(argc >= 3 && !strcmp(argv[1], "record"))
+    {
+        int n = (argc >= 4) ? atoi(argv[3]) : REPLAYTEST_DEFAULT_FRAMES;
+        err = replaytest_record(argv[2], n, styles);
+    }
+    else if(argc >= 3 && !strcmp(argv[1], "play"))
+    {
+        int n = (argc >= 4) ? atoi(argv[3]) : 1;
+        err = replaytest_play(argv[2], n, styles);
+    }
+    else
+    {
+        printf("usage: replaytest record <file> [frames]\n");
+        printf("       replaytest play <file> [loops]\n");
+        err = -1;
+    }
+    return (err == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
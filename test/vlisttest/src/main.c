@@ -14,33 +14,56 @@
 void uilist(
     taa_ui* ui,
     const taa_ui_rect* rect,
+    taa_ui_list* list,
     int* vscroll)
 {
     static taa_ui_rect fillrect={0,0,taa_UI_WIDTH_FILL,taa_UI_HEIGHT_FILL};
-    static taa_ui_rect rowrect={0,0,taa_UI_WIDTH_FILL,taa_UI_HEIGHT_AUTO};
     static taa_ui_rect scrlrect={0,0,taa_UI_WIDTH_DEFAULT,taa_UI_HEIGHT_FILL};
+    taa_ui_rect rowrect={0,0,taa_UI_WIDTH_FILL,0};
     taa_ui_handle scrollhandle;
+    int begin;
+    int end;
     int i;
+    rowrect.h = list->itemheight;
     taa_ui_push_cols(ui, taa_UI_VALIGN_TOP, 2, rect);
-    taa_ui_push_container(ui,UITHEME_SCROLLPANE,0,&fillrect,0,*vscroll,-1);
-    taa_ui_push_rows(ui, taa_UI_HALIGN_LEFT, 0, &fillrect);
-    srand(0);
-    for(i = 0; i < 200; ++i)
+    taa_ui_push_list(
+        ui,
+        UITHEME_SCROLLPANE,
+        0,
+        &fillrect,
+        *vscroll,
+        -1,
+        list,
+        &begin,
+        &end);
+    for(i = begin; i < end; ++i)
     {
-        char lbl[40];
-        int j;
-        for(j = 0; j < sizeof(lbl)-1; ++j)
+        // the content of a row only depends on its index, so rows that
+        // remain visible are copied from the previous frame
+        if(taa_ui_memo_begin(ui, i, i))
         {
-            lbl[j] = rand() % 26 + 'a';
+            char lbl[40];
+            unsigned int seed;
+            int j;
+            // generate the same label for a row every frame, regardless of
+            // which rows are visible
+            seed = ((unsigned int) i) * 2654435761u;
+            for(j = 0; j < sizeof(lbl)-1; ++j)
+            {
+                seed = seed * 1103515245u + 12345u;
+                lbl[j] = (seed >> 16) % 26 + 'a';
+            }
+            lbl[sizeof(lbl)-1] = '\0';
+            j = i & 1;
+            // keying the row by its item index keeps its id stable while
+            // the visible range scrolls
+            taa_ui_push_container(ui,UITHEME_LISTROW0+j,0,&rowrect,0,0,i);
+            taa_ui_label(ui, UITHEME_LABEL, &fillrect, lbl);
+            taa_ui_pop_container(ui, NULL, NULL, NULL);
         }
-        lbl[sizeof(lbl)-1] = '\0';
-        j = i & 1;
-        taa_ui_push_container(ui,UITHEME_LISTROW0+j,0,&rowrect,0,0,-1);
-        taa_ui_label(ui, UITHEME_LABEL, &rowrect, lbl);
-        taa_ui_pop_container(ui, NULL, NULL, NULL);
+        taa_ui_memo_end(ui);
     }
-    taa_ui_pop_rows(ui);
-    scrollhandle = taa_ui_pop_container(ui, NULL, vscroll, NULL);
+    scrollhandle = taa_ui_pop_list(ui, vscroll, NULL);
     taa_ui_vscrollbar(
         ui,
         UITHEME_SCROLLPANE,
@@ -53,8 +76,21 @@ void uilist(
     taa_ui_pop_cols(ui);
 }
 
+typedef struct main_draw_s main_draw;
 typedef struct main_win_s main_win;
 
+// state of the draw callback, which fills the draw list during layout
+struct main_draw_s
+{
+    const uitheme* theme;
+    taa_ui_drawlist* drawlist;
+    taa_ui_drawlist_cmd* cmds;
+    size_t maxcmds;
+    taa_ui_vertex* verts;
+    size_t maxverts;
+    int isdrawing;
+};
+
 struct main_win_s
 {
     taa_window_display windisplay;
@@ -64,6 +100,45 @@ struct main_win_s
     taa_glcontext rc;
 };
 
+//****************************************************************************
+static void main_begin_draw(
+    main_draw* draw)
+{
+    if(!draw->isdrawing)
+    {
+        taa_ui_begin_drawlist(
+            draw->drawlist,
+            draw->cmds,
+            draw->maxcmds,
+            draw->verts,
+            draw->maxverts);
+        draw->isdrawing = 1;
+    }
+}
+
+//****************************************************************************
+static void main_draw_control(
+    void* userdata,
+    const taa_ui_controllist* ctrls,
+    const taa_ui_control* ctrl)
+{
+    main_draw* draw = (main_draw*) userdata;
+    const taa_ui_rect* rect = &ctrl->rect;
+    const taa_ui_rect* clip = &ctrl->cliprect;
+    if((clip->w > 0) &&
+       (clip->h > 0) &&
+       (rect->x+rect->w >= clip->x) &&
+       (rect->y+rect->h >= clip->y) &&
+       (rect->x <= clip->x+clip->w) &&
+       (rect->y <= clip->y+clip->h))
+    {
+        // the draw list is only started once layout runs, so the list of
+        // an unchanged frame is kept
+        main_begin_draw(draw);
+        uitheme_draw_single(draw->theme, ctrls, ctrl, draw->drawlist);
+    }
+}
+
 //****************************************************************************
 static int main_init_window(
     main_win* mwin)
@@ -190,7 +265,11 @@ void main_exec(
     taa_ui_drawlist_cmd* uicmds;
     taa_ui_render_data* uirnd;
     taa_ui_vertex* uiverts;
+    main_draw draw;
+    taa_ui_list uilistdata;
     taa_vertexbuffer vb;
+    size_t numuicmds = 0;
+    size_t numuiverts = 0;
     char txt[32] = { '\0' };
     int32_t vscroll = 0;
     int32_t quit = 0;
@@ -205,6 +284,7 @@ void main_exec(
         uitheme.stylesheet,
         UITHEME_NUM_STYLES,
         &ui);
+    taa_ui_set_options(ui, taa_UI_OPTION_IDLE);
     taa_ui_create_drawlist(&drawlist);
     taa_ui_create_render_data(&uirnd);
     uicmds =(taa_ui_drawlist_cmd*)taa_memalign(16,MAX_UI_DRAW*sizeof(*uicmds));
@@ -212,6 +292,22 @@ void main_exec(
 
     taa_vertexbuffer_create(&vb);
 
+    // the draw list is generated by layout, instead of walking the control
+    // list after taa_ui_end
+    draw.theme = &uitheme;
+    draw.drawlist = drawlist;
+    draw.cmds = uicmds;
+    draw.maxcmds = MAX_UI_DRAW;
+    draw.verts = uiverts;
+    draw.maxverts = MAX_UI_VERTS;
+    draw.isdrawing = 0;
+    taa_ui_set_draw_callback(ui, main_draw_control, &draw);
+
+    memset(&uilistdata, 0, sizeof(uilistdata));
+    uilistdata.numitems = 100000;
+    uilistdata.itemheight = uitheme.stylesheet[UITHEME_LABEL].defaulth;
+    uilistdata.contenth = -1;
+
     taa_keyboard_query(mwin->windisplay, &kb);
     taa_mouse_query(mwin->windisplay, mwin->win, &mouse);
     taa_window_get_size(mwin->windisplay, mwin->win, &vw, &vh);
@@ -225,8 +321,6 @@ void main_exec(
         const taa_window_event* evtitr;
         const taa_window_event* evtend;
         const taa_ui_controllist* uicontrols;
-        size_t numuicmds;
-        size_t numuiverts;
         int numevents;
         unsigned int flags;
         numevents = taa_window_update(
@@ -276,8 +370,16 @@ void main_exec(
         taa_ui_push_rows(ui, taa_UI_HALIGN_LEFT, 3, &fillrect);
         // textbox row
         taa_ui_textbox(ui, UITHEME_TEXTBOX,0,&fillwrect,txt,sizeof(txt),NULL);
+        // help row, wrapped to the width of the window
+        taa_ui_paragraph(
+            ui,
+            UITHEME_LABEL,
+            &fillwrect,
+            "Scroll the list with the mouse wheel or drag the scroll bar. "
+            "Only the visible rows are added to the ui each frame.\n"
+            "Press Ok to quit.");
         // list view row
-        uilist(ui, &fillrect, &vscroll);
+        uilist(ui, &fillrect, &uilistdata, &vscroll);
         // button row
         taa_ui_push_rect(ui,taa_UI_HALIGN_RIGHT,taa_UI_VALIGN_TOP,&fillwrect);
         taa_ui_button(ui, UITHEME_BUTTON, 0, &dfltrect, "Ok", &flags);
@@ -292,21 +394,20 @@ void main_exec(
         // end center
         taa_ui_pop_rect(ui);
         uicontrols = taa_ui_end(ui);
-        // create ui draw list
-        taa_ui_begin_drawlist(
-            drawlist,
-            uicmds,
-            MAX_UI_DRAW,
-            uiverts,
-            MAX_UI_VERTS);
-        uitheme_draw(&uitheme, uicontrols, drawlist);
-        taa_ui_end_drawlist(drawlist, &numuicmds, &numuiverts);
-        // render ui
         taa_vertexbuffer_bind(vb);
-        taa_vertexbuffer_data(
-            numuiverts * sizeof(*uiverts),
-            uiverts,
-            taa_BUFUSAGE_DYNAMIC_DRAW);
+        if(!uicontrols->isunchanged)
+        {
+            // finish the ui draw list. if the controls did not change, the
+            // draw list and vertices from the previous frame are reused
+            main_begin_draw(&draw);
+            taa_ui_end_drawlist(drawlist, &numuicmds, &numuiverts);
+            taa_vertexbuffer_data(
+                numuiverts * sizeof(*uiverts),
+                uiverts,
+                taa_BUFUSAGE_DYNAMIC_DRAW);
+        }
+        draw.isdrawing = 0;
+        // render ui
         taa_ui_render(uirnd, vw, vh, vb, uicmds, numuicmds);
         // flip
         taa_glcontext_swap_buffers(mwin->rcdisplay, mwin->rcsurface);
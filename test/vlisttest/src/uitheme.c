@@ -179,17 +179,33 @@ static void uitheme_draw_textcontrol(
         }
     }
     taa_ui_draw_visual_background(style,vis,rect,clip, drawlist);
-    taa_ui_draw_visual_text(
-        style,
-        vis,
-        rect,
-        clip,
-        txt,
-        len,
-        caret,
-        sel,
-        sellen,
-         drawlist);
+    if(ctrl->type == taa_UI_PARAGRAPH)
+    {
+        taa_ui_draw_visual_paragraph(
+            style,
+            vis,
+            rect,
+            clip,
+            txt,
+            ctrl->data.text.lines,
+            ctrl->data.text.numlines,
+            drawlist);
+    }
+    else
+    {
+        taa_ui_draw_visual_text(
+            style,
+            vis,
+            rect,
+            clip,
+            txt,
+            len,
+            ctrl->data.text.textwidth,
+            caret,
+            sel,
+            sellen,
+             drawlist);
+    }
     taa_ui_draw_visual_border(style,vis,rect,clip, drawlist);
 }
 
@@ -518,6 +534,30 @@ void uitheme_destroy(
     taa_texture2d_destroy(theme->texture);
 }
 
+//****************************************************************************
+void uitheme_draw_single(
+    const uitheme* theme,
+    const taa_ui_controllist* ctrls,
+    const taa_ui_control* ctrl,
+    taa_ui_drawlist* drawlist)
+{
+    switch(ctrl->data.type)
+    {
+    case taa_UI_DATA_ID:
+        uitheme_draw_idcontrol(theme, ctrls, ctrl,  drawlist);
+        break;
+    case taa_UI_DATA_SCROLL:
+        uitheme_draw_scrollcontrol(theme, ctrls, ctrl,  drawlist);
+        break;
+    case taa_UI_DATA_TEXT:
+        uitheme_draw_textcontrol(theme, ctrls, ctrl,  drawlist);
+        break;
+    default:
+        uitheme_draw_control(theme, ctrls, ctrl,  drawlist);
+        break;
+    }
+}
+
 //****************************************************************************
 void uitheme_draw(
     const uitheme* theme,
@@ -537,21 +577,7 @@ void uitheme_draw(
            (rect->x <= clip->x+clip->w) &&
            (rect->y <= clip->y+clip->h))
         {
-            switch(citr->data.type)
-            {
-            case taa_UI_DATA_ID:
-                uitheme_draw_idcontrol(theme, ctrls, citr,  drawlist);
-                break;
-            case taa_UI_DATA_SCROLL:
-                uitheme_draw_scrollcontrol(theme, ctrls, citr,  drawlist);
-                break;
-            case taa_UI_DATA_TEXT:
-                uitheme_draw_textcontrol(theme, ctrls, citr,  drawlist);
-                break;
-            default:
-                uitheme_draw_control(theme, ctrls, citr,  drawlist);
-                break;
-            }
+            uitheme_draw_single(theme, ctrls, citr, drawlist);
         }
         ++citr;
     }
@@ -53,4 +53,11 @@ void uitheme_draw(
     const taa_ui_controllist* ctrls,
     taa_ui_drawlist* drawlist);
 
+// draws one control without testing if it is visible
+void uitheme_draw_single(
+    const uitheme* theme,
+    const taa_ui_controllist* ctrls,
+    const taa_ui_control* ctrl,
+    taa_ui_drawlist* drawlist);
+
 #endif // UITHEME_H_